@@ -1,16 +1,100 @@
 # ifndef BINARY_SOURCE_H_
 # define BINARY_SOURCE_H_
 
+# include <cstdint>		// uint64_t
 # include <vector>
 # include "netplus.h"
+# include "random_generator.h"
+# include "bit_file.h"
 
-enum BinarySourceMode { Random, PseudoRandom, DeterministicCyclic, DeterministicAppendZeros };
+enum BinarySourceMode { Random, PseudoRandom, DeterministicCyclic, DeterministicAppendZeros, BitFile };
 
 using namespace std;
 
+const int MAX_PRBS_PATTERN_LENGTH = 64;
+
+constexpr uint64_t prbsTap(int delay) { return 1ULL << (delay - 1); }
+
+/* Feedback taps of the PRBS generator for each pattern length: the new bit is the XOR of the bits generated delay bits before, for every
+prbsTap(delay) of the mask. Lengths 1 to 32 keep the taps of the original generator (the length 30 ones are not maximal length),
+lengths 33 to 64 use maximal length taps. */
+constexpr uint64_t prbsFeedbackMask[MAX_PRBS_PATTERN_LENGTH + 1] = {
+	0,
+	prbsTap(1),		// 1
+	prbsTap(2) | prbsTap(1),		// 2
+	prbsTap(3) | prbsTap(1),		// 3
+	prbsTap(4) | prbsTap(1),		// 4
+	prbsTap(5) | prbsTap(2),		// 5
+	prbsTap(6) | prbsTap(1),		// 6
+	prbsTap(7) | prbsTap(1),		// 7
+	prbsTap(8) | prbsTap(4) | prbsTap(3) | prbsTap(2),		// 8
+	prbsTap(9) | prbsTap(4),		// 9
+	prbsTap(10) | prbsTap(3),		// 10
+	prbsTap(11) | prbsTap(2),		// 11
+	prbsTap(12) | prbsTap(6) | prbsTap(4) | prbsTap(1),		// 12
+	prbsTap(13) | prbsTap(4) | prbsTap(3) | prbsTap(1),		// 13
+	prbsTap(14) | prbsTap(5) | prbsTap(3) | prbsTap(1),		// 14
+	prbsTap(15) | prbsTap(1),		// 15
+	prbsTap(16) | prbsTap(5) | prbsTap(3) | prbsTap(2),		// 16
+	prbsTap(17) | prbsTap(3),		// 17
+	prbsTap(18) | prbsTap(5) | prbsTap(2) | prbsTap(1),		// 18
+	prbsTap(19) | prbsTap(5) | prbsTap(2) | prbsTap(1),		// 19
+	prbsTap(20) | prbsTap(3),		// 20
+	prbsTap(21) | prbsTap(2),		// 21
+	prbsTap(22) | prbsTap(1),		// 22
+	prbsTap(23) | prbsTap(5),		// 23
+	prbsTap(24) | prbsTap(4) | prbsTap(3) | prbsTap(1),		// 24
+	prbsTap(25) | prbsTap(3),		// 25
+	prbsTap(26) | prbsTap(6) | prbsTap(2) | prbsTap(1),		// 26
+	prbsTap(27) | prbsTap(5) | prbsTap(2) | prbsTap(1),		// 27
+	prbsTap(28) | prbsTap(3),		// 28
+	prbsTap(29) | prbsTap(2),		// 29
+	prbsTap(30) | prbsTap(6) | prbsTap(4) | prbsTap(2),		// 30
+	prbsTap(31) | prbsTap(3),		// 31
+	prbsTap(32) | prbsTap(7) | prbsTap(5) | prbsTap(3) | prbsTap(2) | prbsTap(1),		// 32
+	prbsTap(33) | prbsTap(13),		// 33
+	prbsTap(34) | prbsTap(33) | prbsTap(32) | prbsTap(7),		// 34
+	prbsTap(35) | prbsTap(2),		// 35
+	prbsTap(36) | prbsTap(11),		// 36
+	prbsTap(37) | prbsTap(36) | prbsTap(35) | prbsTap(34) | prbsTap(33) | prbsTap(32),		// 37
+	prbsTap(38) | prbsTap(37) | prbsTap(33) | prbsTap(32),		// 38
+	prbsTap(39) | prbsTap(4),		// 39
+	prbsTap(40) | prbsTap(21) | prbsTap(19) | prbsTap(2),		// 40
+	prbsTap(41) | prbsTap(3),		// 41
+	prbsTap(42) | prbsTap(23) | prbsTap(22) | prbsTap(1),		// 42
+	prbsTap(43) | prbsTap(6) | prbsTap(5) | prbsTap(1),		// 43
+	prbsTap(44) | prbsTap(27) | prbsTap(26) | prbsTap(1),		// 44
+	prbsTap(45) | prbsTap(4) | prbsTap(3) | prbsTap(1),		// 45
+	prbsTap(46) | prbsTap(21) | prbsTap(20) | prbsTap(1),		// 46
+	prbsTap(47) | prbsTap(5),		// 47
+	prbsTap(48) | prbsTap(28) | prbsTap(27) | prbsTap(1),		// 48
+	prbsTap(49) | prbsTap(9),		// 49
+	prbsTap(50) | prbsTap(27) | prbsTap(26) | prbsTap(1),		// 50
+	prbsTap(51) | prbsTap(16) | prbsTap(15) | prbsTap(1),		// 51
+	prbsTap(52) | prbsTap(3),		// 52
+	prbsTap(53) | prbsTap(16) | prbsTap(15) | prbsTap(1),		// 53
+	prbsTap(54) | prbsTap(37) | prbsTap(36) | prbsTap(1),		// 54
+	prbsTap(55) | prbsTap(24),		// 55
+	prbsTap(56) | prbsTap(22) | prbsTap(21) | prbsTap(1),		// 56
+	prbsTap(57) | prbsTap(7),		// 57
+	prbsTap(58) | prbsTap(19),		// 58
+	prbsTap(59) | prbsTap(22) | prbsTap(21) | prbsTap(1),		// 59
+	prbsTap(60) | prbsTap(1),		// 60
+	prbsTap(61) | prbsTap(16) | prbsTap(15) | prbsTap(1),		// 61
+	prbsTap(62) | prbsTap(57) | prbsTap(56) | prbsTap(1),		// 62
+	prbsTap(63) | prbsTap(1),		// 63
+	prbsTap(64) | prbsTap(4) | prbsTap(3) | prbsTap(1)		// 64
+};
+
 /* Generates a bit stream. Three types of sources are implemented (Random, PseudoRandom, DeterministicCyclic). In the Random mode the probability of generate a "0" is
-going to be probabilityOfZero and probability of "1" is given by 1-probabilityOfZero. In the PseudoRandom mode, a PRBS sequence is generated with period
-2^patternLength-1. In the DeterministicCyclic mode it is generated the sequence specified by bitStream.
+going to be probabilityOfZero and probability of "1" is given by 1-probabilityOfZero; the bits come from a xoshiro256** generator seeded once with seed,
+or from std::random_device if seed = -1, so a run can be reproduced from its seed. With streamId >= 0 they come instead from the stream streamId of the
+counter-based generator, keyed by seed or, if seed = -1, by the run seed: every bit then only depends on its position in the stream. In the PseudoRandom mode, a PRBS sequence is generated with period
+2^patternLength-1, patternLength from 1 to MAX_PRBS_PATTERN_LENGTH; it is generated 64 bits at a time. In the DeterministicCyclic mode it is generated the sequence specified by bitStream.
+The stream can start bitOffset bits in (not in the Random mode without streamId): the PRBS jumps there in O(log bitOffset) operations, so long runs can be split in segments that are
+generated independently.
+In the BitFile mode the bits are streamed from the file bitFileName, packed or ASCII (see BitFileFormat), so payloads far too long for
+bitStream can be replayed; at the end of the file the stream stops, or starts again from the beginning if bitFileLoop is true.
 If numberOfBits = -1 it generates an arbitrary large number of bits, otherwise the bit stream length equals numberOfBits.
 The input parameter bitPerido specifies the bit period.
 INPUT PARAMETERS:
@@ -20,13 +104,48 @@ int patternLength{ 7 };
 string bitStream{ "01" };
 long int numberOfBits{ -1 };
 double bitPeriod{ 1.0 / 100e9 };
+long long bitOffset{ 0 };
+long long seed{ -1 };
+long long streamId{ -1 };
+string bitFileName{ "" };
+BitFileFormat bitFileFormat{ PackedBitFile };
+bool bitFileLoop{ false };
 */ 
 class BinarySource : public Block {
 
 	// State variables
-	std::vector<int> acumul;
 	int posBitStream{ 0 };
 
+	uint64_t prbsState{ 0 };				// last patternLength bits of the PRBS, the oldest one in bit 0
+	vector<uint64_t> prbsLeapTable;			// for each byte of prbsState, the next 64 bits due to that byte alone (256 entries per byte)
+
+	Xoshiro256 generator;
+	CounterRng counterGenerator;
+	uint64_t counterIndex{ 0 };				// next sample of the counter-based stream: a word for equiprobable bits, a bit otherwise
+	bool randomInitialized{ false };
+
+	vector<t_binary> patternTile;			// bitStream converted once, in the DeterministicCyclic mode repeated to hold any buffer length run
+	int patternSize{ 0 };
+	bool patternInitialized{ false };
+
+	BitFileReader bitFile;
+	bool bitFileEnded{ false };
+
+	uint64_t bitWord{ 0 };					// bits already generated and not yet put in the output signal, the next one in bit 0
+	int bitWordLeft{ 0 };
+	vector<uint64_t> words;
+
+	void initializePrbs(void);
+	uint64_t nextPrbsWord(void);			// next 64 bits of the PRBS, the first one in bit 0
+	void initializeRandom(void);
+	void nextWords(uint64_t *out, int n);	// next n words of the PseudoRandom or of the equiprobable Random stream
+	void putBits(int n);					// puts the next n bits of nextWords() in the output signal
+	void putRandomBits(int n);				// puts n Random bits with P(0) = probabilityOfZero, one generator word per bit
+	void initializePattern(void);
+	void putPatternBits(int n);				// puts the next n bits of the DeterministicCyclic or DeterministicAppendZeros stream
+	void initializeBitFile(void);
+	int putFileBits(int n);					// puts up to n bits of the BitFile stream, returns the number put
+
  public:
 
 	 // Input parameters
@@ -40,6 +159,15 @@ class BinarySource : public Block {
 	 long int numberOfBits{ -1 };
 	 double bitPeriod{ 1.0 / 100e9 };
 
+	 long long bitOffset{ 0 };		// number of bits of the stream skipped at the beginning
+
+	 long long seed{ -1 };			// Random mode, -1 seeds the generator from std::random_device, or uses the run seed with a streamId
+	 long long streamId{ -1 };		// Random mode, >= 0 draws the bits from this stream of the counter-based generator
+
+	 string bitFileName{ "" };						// BitFile mode
+	 BitFileFormat bitFileFormat{ PackedBitFile };
+	 bool bitFileLoop{ false };
+
 
 	// Methods
 	 BinarySource(vector<Signal *> &InputSig, vector<Signal *> &OutputSig) :Block(InputSig, OutputSig){};
@@ -63,6 +191,24 @@ class BinarySource : public Block {
 	void setPatternLength(int pLength) { patternLength = pLength; };
 	int const getPatternLength(void) { return patternLength; }
 	
+	void setBitOffset(long long bOffset) { bitOffset = max(bOffset, 0LL); };		// before the simulation starts
+	long long const getBitOffset(void) { return bitOffset; }
+
+	void setSeed(long long s) { seed = s; };		// before the simulation starts
+	long long const getSeed(void) { return seed; }
+
+	void setStreamId(long long sId) { streamId = sId; };		// before the simulation starts
+	long long const getStreamId(void) { return streamId; }
+
+	void setBitFileName(string fName) { bitFileName = fName; };		// before the simulation starts
+	string const getBitFileName(void) { return bitFileName; }
+
+	void setBitFileFormat(BitFileFormat fFormat) { bitFileFormat = fFormat; };
+	BitFileFormat const getBitFileFormat(void) { return bitFileFormat; }
+
+	void setBitFileLoop(bool fLoop) { bitFileLoop = fLoop; };
+	bool const getBitFileLoop(void) { return bitFileLoop; }
+
 	void setBitPeriod(double bPeriod);
 	double const getBitPeriod(void) { return bitPeriod; }
 
@@ -0,0 +1,52 @@
+# ifndef BIT_FILE_H_
+# define BIT_FILE_H_
+
+# include <cstdint>		// uint64_t
+# include <string>
+# include "netplus.h"
+
+using namespace std;
+
+/* PackedBitFile: 8 bits per byte, the most significant bit of each byte first.
+AsciiBitFile: one bit per '0' or '1' character, any other character (blank, end of line, ...) is skipped. */
+enum BitFileFormat { PackedBitFile, AsciiBitFile };
+
+const long long BIT_FILE_WINDOW = 64LL << 20;		// bytes mapped at a time, a multiple of the mapping granularity of every platform
+
+/* Sequential reader of a bit file of any size. The file is memory mapped a window of BIT_FILE_WINDOW bytes at a time, and the
+operating system is asked to read the next window ahead while the current one is consumed, so a multi-gigabyte file is streamed
+with a bounded address space and without copies through stdio buffers. */
+class BitFileReader {
+
+	long long fileSize{ 0 };				// bytes
+	long long windowOffset{ 0 };			// file offset of the mapped window
+	long long windowLength{ 0 };
+	const unsigned char *window{ nullptr };
+	long long position{ 0 };				// file offset of the next byte
+	int bitInByte{ 0 };						// PackedBitFile, bits of the byte at position already read
+	BitFileFormat format{ PackedBitFile };
+
+	intptr_t fileHandle{ -1 };
+	intptr_t mappingHandle{ 0 };
+
+	bool mapWindow(long long offset);		// maps the window holding offset
+	void unmapWindow(void);
+
+public:
+
+	BitFileReader() {};
+	~BitFileReader() { close(); };
+
+	BitFileReader(const BitFileReader &) = delete;
+	BitFileReader &operator=(const BitFileReader &) = delete;
+
+	bool open(const string &fileName, BitFileFormat fileFormat);	// false if the file cannot be opened
+	void close(void);
+	bool isOpen(void) const { return fileHandle != -1; };
+
+	void rewind(void);
+	long long skip(long long n);			// skips up to n bits, returns the number skipped: a seek in PackedBitFile files, a scan in AsciiBitFile ones
+	int read(t_binary *bits, int n);		// reads up to n bits, returns the number read, 0 at the end of the file
+};
+
+# endif
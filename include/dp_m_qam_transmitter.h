@@ -0,0 +1,122 @@
+# ifndef DP_M_QAM_TRANSMITTER_H_
+# define DP_M_QAM_TRANSMITTER_H_
+
+# include "netplus.h"
+# include "m_qam_transmitter.h"
+# include "polarization_multiplexer.h"
+
+/* Dual-polarization M-QAM transmitter: two MQamTransmitters, one per polarization, combined into a BandpassSignalXY. Every parameter is
+set on both tributaries, and each one transmits half of the outputOpticalPower. The Y tributary carries different bits: unless a
+yBitOffset is set, it starts half a PRBS period after X in the PseudoRandom mode and half the bitStream after X in the DeterministicCyclic
+mode, and in the Random mode it uses the seed + 1 and, if one is set, the streamId + 1 of X. In the DeterministicAppendZeros and BitFile
+modes the two tributaries carry the same bits unless a yBitOffset is set, as a shift would only cut the Y stream short. */
+class DpMQamTransmitter : public SuperBlock {
+
+	/* State Variables */
+
+	// #####################################################################################################
+	// ################## Internal Signals Declaration and Inicialization ##################################
+	// #####################################################################################################
+
+	BandpassSignal S1{ "DPMQAM1.sgn" };
+
+	BandpassSignal S2{ "DPMQAM2.sgn" };
+
+	BandpassSignalXY S3{ "DPMQAM3.sgn" };
+
+
+	// #####################################################################################################
+	// ########################### Blocks Declaration and Inicialization ###################################
+	// #####################################################################################################
+
+	MQamTransmitter B1{ vector<Signal*> {}, vector<Signal*> { &S1 } };
+
+	MQamTransmitter B2{ vector<Signal*> {}, vector<Signal*> { &S2 } };
+
+	PolarizationMultiplexer B3{ vector<Signal*> { &S1, &S2 }, vector<Signal*> { &S3 } };
+
+public:
+
+	/* Input Parameters */
+
+	long long yBitOffset{ -1 };		// bits of the Y stream skipped at the beginning, -1 for half a period after X (see above)
+
+	/* Methods */
+
+	DpMQamTransmitter(vector<Signal *> &inputSignal, vector<Signal *> &outputSignal):SuperBlock(inputSignal, outputSignal){ setModuleBlocks({ &B1, &B2, &B3 }); };
+
+	void initialize(void);
+
+	/* Set Methods */
+
+	void set(int opt);
+
+	void setIqPulseShaping(IqPulseShaping iqShaping) { B1.setIqPulseShaping(iqShaping); B2.setIqPulseShaping(iqShaping); };
+	IqPulseShaping const getIqPulseShaping(void) { return B1.getIqPulseShaping(); };
+
+	void setMode(BinarySourceMode m) { B1.setMode(m); B2.setMode(m); };
+	BinarySourceMode const getMode(void) { return B1.getMode(); };
+
+	void setProbabilityOfZero(double pZero) { B1.setProbabilityOfZero(pZero); B2.setProbabilityOfZero(pZero); };
+	double const getProbabilityOfZero(void) { return B1.getProbabilityOfZero(); };
+
+	void setBitStream(string bStream) { B1.setBitStream(bStream); B2.setBitStream(bStream); };
+	string const getBitStream(void) { return B1.getBitStream(); };
+
+	void setBitFileName(string fName) { B1.setBitFileName(fName); B2.setBitFileName(fName); };
+	string const getBitFileName(void) { return B1.getBitFileName(); };
+
+	void setBitFileFormat(BitFileFormat fFormat) { B1.setBitFileFormat(fFormat); B2.setBitFileFormat(fFormat); };
+	BitFileFormat const getBitFileFormat(void) { return B1.getBitFileFormat(); };
+
+	void setBitFileLoop(bool fLoop) { B1.setBitFileLoop(fLoop); B2.setBitFileLoop(fLoop); };
+	bool const getBitFileLoop(void) { return B1.getBitFileLoop(); };
+
+	void setNumberOfBits(long int nOfBits) { B1.setNumberOfBits(nOfBits); B2.setNumberOfBits(nOfBits); }
+	long int const getNumberOfBits(void) { return B1.getNumberOfBits(); }
+
+	void setPatternLength(int pLength) { B1.setPatternLength(pLength); B2.setPatternLength(pLength); }
+	int const getPatternLength(void) { return B1.getPatternLength(); }
+
+	void setBitPeriod(double bPeriod) { B1.setBitPeriod(bPeriod); B2.setBitPeriod(bPeriod); };
+	double const getBitPeriod(void) { return B1.getBitPeriod(); }
+
+	void setBitOffset(long long bOffset) { B1.setBitOffset(bOffset); };
+	long long const getBitOffset(void) { return B1.getBitOffset(); }
+
+	void setYBitOffset(long long bOffset) { yBitOffset = bOffset; };
+	long long const getYBitOffset(void) { return yBitOffset; }
+
+	void setSeed(long long s) { B1.setSeed(s); B2.setSeed((s == -1) ? -1 : s + 1); };
+	long long const getSeed(void) { return B1.getSeed(); }
+
+	void setStreamId(long long sId) { B1.setStreamId(sId); B2.setStreamId((sId < 0) ? -1 : sId + 1); };
+	long long const getStreamId(void) { return B1.getStreamId(); }
+
+	void setM(int mValue) { B1.setM(mValue); B2.setM(mValue); };
+	int const getM(void) { return B1.getM(); };
+
+	void setIqAmplitudes(vector<t_iqValues> iqAmplitudesValues) { B1.setIqAmplitudes(iqAmplitudesValues); B2.setIqAmplitudes(iqAmplitudesValues); };
+	vector<t_iqValues> const getIqAmplitudes(void) { return B1.getIqAmplitudes(); };
+
+	void setNumberOfSamplesPerSymbol(int n) { B1.setNumberOfSamplesPerSymbol(n); B2.setNumberOfSamplesPerSymbol(n); };
+	int const getNumberOfSamplesPerSymbol(void) { return B1.getNumberOfSamplesPerSymbol(); };
+
+	void setRollOffFactor(double rOffFactor) { B1.setRollOffFactor(rOffFactor); B2.setRollOffFactor(rOffFactor); };
+	double const getRollOffFactor(void) { return B1.getRollOffFactor(); };
+
+	void setLookUpTableMaxSize(int maxSize) { B1.setLookUpTableMaxSize(maxSize); B2.setLookUpTableMaxSize(maxSize); };
+	int const getLookUpTableMaxSize(void) { return B1.getLookUpTableMaxSize(); };
+
+	void setSeeBeginningOfImpulseResponse(bool sBeginningOfImpulseResponse) { B1.setSeeBeginningOfImpulseResponse(sBeginningOfImpulseResponse); B2.setSeeBeginningOfImpulseResponse(sBeginningOfImpulseResponse); };
+	double const getSeeBeginningOfImpulseResponse(void) { return B1.getSeeBeginningOfImpulseResponse(); };
+
+	void setOutputOpticalPower(t_real outOpticalPower) { B1.setOutputOpticalPower(outOpticalPower / 2); B2.setOutputOpticalPower(outOpticalPower / 2); };
+	t_real const getOutputOpticalPower(void) { return 2 * B1.getOutputOpticalPower(); };
+
+	void setOutputOpticalPower_dBm(t_real outOpticalPower_dBm) { setOutputOpticalPower(1e-3*pow(10, outOpticalPower_dBm / 10)); };
+	t_real const getOutputOpticalPower_dBm(void) { return 10*log10(getOutputOpticalPower()/1e-3); }
+
+};
+
+#endif
@@ -0,0 +1,140 @@
+# ifndef DSP_KERNELS_H_
+# define DSP_KERNELS_H_
+
+# include <cstdint>		// uint64_t
+# include <string>
+# include "netplus.h"
+
+using namespace std;
+
+/* Run-time dispatch of the DSP kernels used in the blocks inner loops.
+The instruction set is detected once, at the first call to dspKernels(), and the table of the best supported level is used from then on.
+The level can be lowered for testing with the environment variable NETPLUS_ISA (scalar, avx2 or avx512); a level that the processor
+does not support is never selected; the avx512 level needs AVX-512F and AVX-512BW, for the 16-bit integer kernels. The scalar kernels
+accumulate in the same order as the original loops, so they give bit-exact results; the vector kernels only differ from them by rounding.
+Kernels work on contiguous arrays, t_complex values are stored as interleaved (re, im) pairs, split complex arrays as two planes. The vector kernels are compiled for the
+t_real of the build, so a NETPLUS_SINGLE_PRECISION build processes twice as many samples per instruction.
+The dot products, complexScale, complexMultiply, interleave, deinterleave, unpackBits, fixedDotProduct, fftStage and the Jones matrix
+kernels are written with intrinsics. The other kernels, and the polyphase FIR and QAM mapper kernels below, are one
+generic loop compiled once per level with a function target attribute, and so are only vectorized per level by GCC and Clang. MSVC has
+no such attribute: there they are compiled once for the /arch of the build, and the AVX2 and AVX-512 entries run that same code. */
+
+enum DspIsa { ScalarIsa, Avx2Isa, Avx512Isa };
+
+struct DspKernels {
+
+	DspIsa isa;
+
+	// sum x[m] * h[m], m = 0, ..., n-1
+	t_real(*dotProduct)(const t_real *x, const t_real *h, int n);
+
+	// sum x[m] * h[m], m = 0, ..., n-1, complex samples and real taps
+	t_complex(*complexDotProduct)(const t_complex *x, const t_real *h, int n);
+
+	// out[m] = scale * in[m], in-place allowed
+	void(*complexScale)(const t_complex *in, t_real scale, t_complex *out, int n);
+
+	// out[m] = a[m] * b[m], in-place allowed
+	void(*complexMultiply)(const t_complex *a, const t_complex *b, t_complex *out, int n);
+
+	// out[m] = (re[m], im[m])
+	void(*interleave)(const t_real *re, const t_real *im, t_complex *out, int n);
+
+	// re[m] = real(in[m]), im[m] = imag(in[m])
+	void(*deinterleave)(const t_complex *in, t_real *re, t_real *im, int n);
+
+	// bits[i] = bit (i mod 64) of words[i / 64], least significant bit first
+	void(*unpackBits)(const uint64_t *words, t_binary *bits, int n);
+
+	// sum x[m] * h[m], m = 0, ..., n-1, exact integer result; the taps h must not hold the code -32768
+	long long(*fixedDotProduct)(const t_fixed *x, const t_fixed *h, int n);
+
+	// out[m] = scale * in[m], real arrays such as the planes of a SplitPlanes complex signal, in-place allowed
+	void(*realScale)(const t_real *in, t_real scale, t_real *out, int n);
+
+	// out[m] = a[m] * b[m], complex arrays given as real and imaginary planes, in-place allowed
+	void(*splitComplexMultiply)(const t_real *aRe, const t_real *aIm, const t_real *bRe, const t_real *bIm, t_real *outRe, t_real *outIm, int n);
+
+	// bits[m] = 1 if values[m] >= threshold, 0 otherwise; with uniform values P(0) = threshold / 2^64
+	void(*thresholdBits)(const uint64_t *values, uint64_t threshold, t_binary *bits, int n);
+
+	// out[2k], out[2k+1] = Philox4x32-10 output of the counter (firstBlock + k, stream) with the key, k = 0, ..., n-1
+	void(*philox)(uint64_t key, uint64_t stream, uint64_t firstBlock, uint64_t *out, int n);
+
+	// s[m] = sin(x[m]), c[m] = cos(x[m]), by polynomials instead of libm, accurate to an ulp or two of double for |x[m]| < 2^20
+	void(*sinCos)(const t_real *x, t_real *s, t_real *c, int n);
+
+	// Nested Mach-Zehnder modulator, with xI = phaseScale * vI[m] + phaseI, xQ = phaseScale * vQ[m] + phaseQ:
+	// re[m] = amplitude * (sin(xI) - leakage * cos(xQ)), im[m] = amplitude * (leakage * cos(xI) + sin(xQ)), the sines as in sinCos
+	void(*iqMachZehnder)(const t_real *vI, const t_real *vQ, t_real phaseScale, t_real phaseI, t_real phaseQ, t_real leakage, t_real amplitude, t_real *re, t_real *im, int n);
+
+	// re[m] = magnitude[m] * cos(phase[m]), im[m] = magnitude[m] * sin(phase[m]), the sines as in sinCos
+	void(*polar)(const t_real *magnitude, const t_real *phase, t_real *re, t_real *im, int n);
+
+	// out[2p], out[2p+1] = independent standard Gaussian samples from the uniform words[2p], words[2p+1] (Box-Muller), p = 0, ..., n-1
+	void(*boxMuller)(const uint64_t *words, t_real *out, int n);
+
+	// One radix-2 FFT stage, in place: for each block of 2 * half values, x[j], x[j + half] = x[j] +- twiddles[j] * x[j + half], j = 0, ..., span-1;
+	// a whole stage has span = half, a stage split in pieces is run with x and twiddles offset to each piece
+	void(*fftStage)(t_complex *x, const t_complex *twiddles, int half, int span, int n);
+
+	// x[m] = x[m] * exp(j * scale * |x[m]|^2), in place, the sines as in sinCos; returns the largest |x[m]|^2
+	t_real(*kerrPhase)(t_complex *x, t_real scale, int n);
+
+	// x[m] = gain * x[m] * exp(j * length * phase[m]), in place, the sines as in sinCos
+	void(*dispersionStep)(t_complex *x, const t_real *phase, t_real length, t_real gain, int n);
+
+	// sum x[m]^2, accumulated in double, a complex array passed as 2n reals gives its energy
+	double(*sumOfSquares)(const t_real *x, int n);
+
+	// out[m] = scale * in[m] + noiseScale * noise[m], real arrays or complex arrays passed as 2n reals, in-place allowed
+	void(*realScaleAdd)(const t_real *in, t_real scale, const t_real *noise, t_real noiseScale, t_real *out, int n);
+
+	// out[m] = J in[m], the same Jones matrix J for every dual-polarization sample: x' = xx x + xy y, y' = yx x + yy y, in-place allowed
+	void(*jonesMatrix)(const t_complex_xy *in, const t_jones *matrix, t_complex_xy *out, int n);
+
+	// out[m] = matrices[m] in[m], a Jones matrix per sample, or per frequency bin of the FFT of each polarization, in-place allowed
+	void(*jonesMatrices)(const t_complex_xy *in, const t_jones *matrices, t_complex_xy *out, int n);
+};
+
+/* Polyphase FIR kernels with the number of branches and of taps per branch fixed at compile time, for the shapes used in production
+(8, 16 or 32 branches with 8, 16 or 32 taps each). One call computes the outputs of all the branches for the current symbol window:
+out[p] = sum window[m] * taps[m * numberOfPhases + p], m = 0, ..., tapsPerPhase-1, with the taps stored tap by tap so that the
+branches are the vectorized dimension. Every output is accumulated in the same order as dotProduct, so with the scalar kernels the
+results are identical. */
+typedef void(*PolyphaseFirKernel)(const t_real *window, const t_real *taps, t_real *out);
+typedef void(*ComplexPolyphaseFirKernel)(const t_complex *window, const t_real *taps, t_complex *out);
+
+PolyphaseFirKernel getPolyphaseFirKernel(int numberOfPhases, int tapsPerPhase);				// nullptr for other shapes
+ComplexPolyphaseFirKernel getComplexPolyphaseFirKernel(int numberOfPhases, int tapsPerPhase);	// nullptr for other shapes
+
+/* Fixed-point polyphase FIR kernels, for the same shapes, that shape n symbols in one call: the window of symbol s is symbols[s], ...,
+symbols[s + tapsPerPhase - 1], the oldest first, and out[s * numberOfPhases + p] = sum symbols[s + m] * tap m of branch p. The taps are
+stored in pairs, taps[2 * (k * numberOfPhases + p) + j] being the tap 2k + j of branch p, so that one 16-bit multiply-add gives two
+products of every branch and all the branches of a symbol are computed at once. The sums are accumulated in 32 bits: they are exact when
+the largest symbol code times the largest sum of the |taps| of a branch is below 2^31, which the caller must check (fixedPolyphaseFirFits). */
+typedef void(*FixedPolyphaseFirKernel)(const t_fixed *symbols, const t_fixed *taps, t_integer *out, int n);
+
+FixedPolyphaseFirKernel getFixedPolyphaseFirKernel(int numberOfPhases, int tapsPerPhase);		// nullptr for other shapes
+bool fixedPolyphaseFirFits(const t_fixed *taps, int numberOfPhases, int tapsPerPhase, int maxSymbolCode);	// taps as for the kernels
+
+/* Gray labelled square QAM mapping kernels with the number of bits per symbol fixed at compile time, for the constellations used in
+production (QPSK, 16-QAM and 64-QAM, 2, 4 or 6 bits). Symbol k is read from bits[bitsPerSymbol * k], the most significant bit first:
+the first half of its bits gives the I level and the second half the Q level, each Gray decoded with running XORs, so the mapping is
+arithmetic and vectorized across the symbols instead of looked up. The amplitude of level p out of L is (2p - (L-1)) * scale, the same
+operations as grayQamConstellation, so with its scale the outputs are identical to the table lookup. */
+typedef void(*QamMapperKernel)(const t_binary *bits, t_real scale, t_real *i, t_real *q, int n);
+typedef void(*ComplexQamMapperKernel)(const t_binary *bits, t_real scale, t_complex *out, int n);
+
+QamMapperKernel getQamMapperKernel(int bitsPerSymbol);					// nullptr for other constellations
+ComplexQamMapperKernel getComplexQamMapperKernel(int bitsPerSymbol);	// nullptr for other constellations
+
+const DspKernels &dspKernels(void);		// table selected for this process
+
+DspIsa detectDspIsa(void);				// best level supported by the processor and the operating system
+
+const DspKernels &getDspKernels(DspIsa isa);	// table of a given level, for tests and benchmarks, isa must be supported
+
+string dspIsaName(DspIsa isa);
+
+# endif
@@ -0,0 +1,40 @@
+# ifndef FFT_H_
+# define FFT_H_
+
+# include <vector>
+# include <memory>		// shared_ptr
+# include "netplus.h"
+
+using namespace std;
+
+/* Immutable plan of a complex FFT of a power of two size: the bit reversal permutation and the twiddle factors of every radix-2 stage,
+stored contiguously per stage so that the butterflies (dspKernels().fftStage) run on unit-stride arrays.
+forward() computes X[k] = sum x[m] exp(-j2pi km/size), inverse() the same sum with exp(+j2pi km/size), without the 1/size factor.
+With numberOfThreads > 1 a large transform is split on the workerPool(): the first stages run on numberOfThreads contiguous chunks, one per
+thread, and each later stage is cut into numberOfThreads pieces of every block.
+A plan holds no working storage, so it can be used by several threads at once. */
+class FftPlan {
+
+	int size;
+	vector<int> swaps;						// pairs (i, j), i < j, of the bit reversal permutation
+	vector<t_complex> forwardTwiddles;		// stage with half-length h: exp(-j pi k/h), k < h, from index h - 1 on
+	vector<t_complex> inverseTwiddles;
+
+	void transform(t_complex *x, const vector<t_complex> &twiddles, int numberOfThreads) const;
+
+public:
+
+	FftPlan(int n);
+
+	int getSize(void) const { return size; };
+
+	void forward(t_complex *x, int numberOfThreads = 1) const;		// in place
+	void inverse(t_complex *x, int numberOfThreads = 1) const;		// in place, unnormalized
+};
+
+// Thread-safe access to the process-wide plan cache, size must be a power of 2.
+shared_ptr<const FftPlan> getFftPlan(int size);
+
+int nextPowerOfTwo(int n);					// smallest power of 2 >= n
+
+# endif
@@ -0,0 +1,136 @@
+# ifndef FIBER_SPAN_H_
+# define FIBER_SPAN_H_
+
+# include <memory>		// shared_ptr
+# include "netplus.h"
+# include "fft.h"
+# include "overlap_save.h"
+
+using namespace std;
+
+enum FiberStepControl { FixedStep, NonlinearPhaseStep, LocalErrorStep };
+
+/* Single-mode fiber span. The complex envelope A of the input BandpassSignal, in sqrt(W), is propagated over the span length by the
+symmetric split-step Fourier solution of the nonlinear Schroedinger equation
+	dA/dz = -alpha/2 A - j beta2/2 d2A/dt2 + beta3/6 d3A/dt3 + j gamma |A|^2 A,
+with beta2 and beta3 obtained from the dispersion and dispersion slope at the centralWavelength of the input signal, over the bandwidth
+1/samplingPeriod of the input signal. Each step is a linear half step in the frequency domain, the Kerr phase rotation of the whole step
+(dspKernels().kerrPhase) and a second linear half step; the half steps of consecutive steps are merged, except with LocalErrorStep.
+The step length is set by stepControl:
+	FixedStep, the span is divided in equal steps of at most stepLength;
+	NonlinearPhaseStep, each step is as long as the Kerr phase of the peak power of the frame stays below maximumNonlinearPhase, up to
+	maximumStepLength, so that low power frames take few steps;
+	LocalErrorStep, each step of 2h is compared with two steps of h and the difference, relative to the field, is kept between localError/2
+	and localError by changing h by factors of 2^(1/3); the two results are combined in a fourth order estimate (O. Sinkin et al., 2003).
+The signal is streamed by overlap-save frames of fftSize samples: each frame holds, before its new samples, the last 2*guard samples of
+the previous one, where guard holds all but FILTER_TRUNCATION of the energy of the impulse response of the dispersion of the span, for
+signals with no power in the outer fifth of the band (impulseResponseGuard()). The output is the propagated input delayed by guard samples
+(getDelay()); at the end of the input (see endInput()) the last frame is zero-padded, so the output is as long as the input. The input
+is read in batches of framesPerBatch frames that are propagated in parallel on numberOfThreads threads of the workerPool(); a batch of a
+single frame splits its FFTs across the threads instead. The frames are independent, so the output does not depend on the number of
+threads. The FFT plans are shared by all the spans of the same frame size (getFftPlan()). */
+class FiberSpan : public Block {
+
+	/* State Variables */
+
+	bool firstTime{ true };
+
+	shared_ptr<const FftPlan> plan;
+	int frameSize{ 0 };
+	int guard{ 0 };
+
+	double alpha{ 0 };						// 1/m
+	double gamma{ 0 };						// 1/(W m)
+	vector<t_real> dispersionPhase;			// phase of the linear operator per meter, per frequency bin
+
+	int numberOfSteps{ 0 };					// FixedStep
+	vector<t_complex> stepResponse;			// FixedStep, linear operator of one step, and of a half step, with the 1/frameSize of the inverse FFT
+	vector<t_complex> halfStepResponse;
+
+	OverlapSaveBuffer<t_complex> batch;		// framesPerBatch frames, propagated into the output frames
+	vector<t_complex> scratch;				// LocalErrorStep, two frames per frame of the batch
+	long long stepsTaken{ 0 };
+
+	void propagate(int frames, int samples);		// the first frames of the batch, holding samples new samples
+
+	// Propagation of one frame, in place in the time domain, returns the number of steps
+	int fixedSteps(t_complex *x, int threads);
+	int nonlinearPhaseSteps(t_complex *x, int threads);
+	int localErrorSteps(t_complex *x, t_complex *coarse, t_complex *fine, int threads);
+	void linearStep(t_complex *x, double distance);		// frequency domain, with the 1/frameSize of the inverse FFT
+	void fullStep(t_complex *x, double h, int threads);
+	t_real kerrScale(double h);								// gamma times the effective length of a step of h
+
+ public:
+
+	/* Input Parameters */
+
+	double length{ 80e3 };							// m
+	double attenuation_dB_km{ 0.2 };
+	double dispersion_ps_nm_km{ 16.7 };
+	double dispersionSlope_ps_nm2_km{ 0.057 };
+	double nonlinearCoefficient_1_W_km{ 1.3 };		// gamma
+	FiberStepControl stepControl{ NonlinearPhaseStep };
+	double stepLength{ 1e3 };						// m, FixedStep longest step, LocalErrorStep first step
+	double maximumStepLength{ 20e3 };				// m, NonlinearPhaseStep and LocalErrorStep
+	double maximumNonlinearPhase{ 5e-3 };			// rad, NonlinearPhaseStep
+	double localError{ 1e-5 };						// LocalErrorStep
+	int fftSize{ 0 };								// power of 2, 0 to choose the smallest one of at least 8 times guard and 1024
+	int guardLength{ 0 };							// samples, 0 to derive the guard from the dispersion
+	int numberOfThreads{ 0 };						// 0 for all the threads of the workerPool()
+	int framesPerBatch{ 0 };						// 0 for one frame per thread
+
+	/* Methods */
+
+	FiberSpan(vector<Signal *> &InputSig, vector<Signal *> &OutputSig) :Block(InputSig, OutputSig){};
+
+	void initialize(void);
+	bool runBlock(void);
+
+	void setLength(double l) { length = l; };
+	double const getLength(void) { return length; };
+
+	void setAttenuation_dB_km(double a) { attenuation_dB_km = a; };
+	double const getAttenuation_dB_km(void) { return attenuation_dB_km; };
+
+	void setDispersion_ps_nm_km(double d) { dispersion_ps_nm_km = d; };
+	double const getDispersion_ps_nm_km(void) { return dispersion_ps_nm_km; };
+
+	void setDispersionSlope_ps_nm2_km(double s) { dispersionSlope_ps_nm2_km = s; };
+	double const getDispersionSlope_ps_nm2_km(void) { return dispersionSlope_ps_nm2_km; };
+
+	void setNonlinearCoefficient_1_W_km(double g) { nonlinearCoefficient_1_W_km = g; };
+	double const getNonlinearCoefficient_1_W_km(void) { return nonlinearCoefficient_1_W_km; };
+
+	void setStepControl(FiberStepControl c) { stepControl = c; };
+	FiberStepControl const getStepControl(void) { return stepControl; };
+
+	void setStepLength(double h) { stepLength = h; };
+	double const getStepLength(void) { return stepLength; };
+
+	void setMaximumStepLength(double h) { maximumStepLength = h; };
+	double const getMaximumStepLength(void) { return maximumStepLength; };
+
+	void setMaximumNonlinearPhase(double phi) { maximumNonlinearPhase = phi; };
+	double const getMaximumNonlinearPhase(void) { return maximumNonlinearPhase; };
+
+	void setLocalError(double e) { localError = e; };
+	double const getLocalError(void) { return localError; };
+
+	void setFftSize(int n) { fftSize = n; };
+	int const getFftSize(void) { return frameSize; };
+
+	void setGuardLength(int g) { guardLength = g; };
+
+	void setNumberOfThreads(int n) { numberOfThreads = n; };
+	int const getNumberOfThreads(void) { return numberOfThreads; };
+
+	void setFramesPerBatch(int n) { framesPerBatch = n; };
+	int const getFramesPerBatch(void) { return framesPerBatch; };
+
+	long long const getStepsTaken(void) { return stepsTaken; };		// split steps of all the frames so far, LocalErrorStep trials included
+
+	int const getDelay(void) { return guard; };		// samples, valid after initialize()
+};
+
+# endif
@@ -0,0 +1,55 @@
+# ifndef FIXED_POINT_H_
+# define FIXED_POINT_H_
+
+# include <math.h>		// ldexp
+# include "netplus.h"
+
+using namespace std;
+
+enum FixedPointRounding { Truncation, RoundHalfUp, RoundHalfEven };
+
+enum FixedPointOverflow { Saturation, WrapAround };
+
+const int MAX_FIXED_POINT_WORD_LENGTH = 16;	// t_fixed bits
+
+/* Two's complement fixed-point format Q(integerBits).(fractionBits), stored in t_fixed codes of wordLength = 1 + integerBits + fractionBits
+bits (at most MAX_FIXED_POINT_WORD_LENGTH). The code of the value v is v * 2^fractionBits, rounded and kept in range as selected by
+rounding and overflow. It models the arithmetic of the transmitter DSP and DAC paths bit by bit.
+INPUT PARAMETERS:
+int integerBits{ 0 };
+int fractionBits{ 15 };
+FixedPointRounding rounding{ RoundHalfEven };
+FixedPointOverflow overflow{ Saturation };
+*/
+class FixedPointFormat {
+
+public:
+
+	/* Input Parameters */
+
+	int integerBits{ 0 };							// the sign bit not included
+	int fractionBits{ 15 };
+
+	FixedPointRounding rounding{ RoundHalfEven };
+	FixedPointOverflow overflow{ Saturation };
+
+	/* Methods */
+
+	FixedPointFormat(){};
+	FixedPointFormat(int iBits, int fBits) { integerBits = iBits; fractionBits = fBits; };
+	FixedPointFormat(int iBits, int fBits, FixedPointRounding fRounding, FixedPointOverflow fOverflow) { integerBits = iBits; fractionBits = fBits; rounding = fRounding; overflow = fOverflow; };
+
+	int wordLength(void) const { return 1 + integerBits + fractionBits; };
+	t_integer maxCode(void) const { return (1 << (wordLength() - 1)) - 1; };
+	t_integer minCode(void) const { return -(1 << (wordLength() - 1)); };
+
+	t_fixed quantize(t_real value) const;									// real value to code
+	t_fixed requantize(long long accumulator, int accumulatorFractionBits) const;	// exact integer result to code
+	void requantize(const t_integer *accumulators, int accumulatorFractionBits, t_fixed *codes, int n) const;	// the same for n results
+	t_real toReal(t_fixed code) const { return (t_real)ldexp((double)code, -fractionBits); };
+
+	void setFormatOf(Signal *signal) const { signal->setFixedPointFormat(integerBits, fractionBits); };
+
+};
+
+# endif
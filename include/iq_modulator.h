@@ -5,13 +5,25 @@
 # include "netplus.h"
 
 
-// Implements a IQ modulator.
+enum IqModulatorTransfer { LinearModulator, MachZehnderModulator };
+
+// Implements a IQ modulator. The I and Q drive signals are either two real (or fixed-point) input signals or one complex input signal.
+// Complex signals can use either layout; a SplitPlanes output is written plane by plane, without shuffles.
+// The LinearModulator output field is .5*sqrt(outputOpticalPower)*(I + jQ). The MachZehnderModulator is a nested modulator whose
+// child modulators, driven push-pull by the I and Q voltages and biased biasI and biasQ volts off their null point, each transmit
+// sin(pi/2*(v + bias)/vPi) + j*leakage*cos(pi/2*(v + bias)/vPi) of .5*sqrt(outputOpticalPower), with leakage = 10^(-extinctionRatio_dB/20);
+// the Q branch is combined in quadrature. The sines are polynomial evaluations vectorized across the samples (dspKernels().iqMachZehnder).
 class IqModulator : public Block {
 
 	/* State Variables */
 
 	bool firstTime{ true };
 
+	vector<t_real> driveI, driveQ;		// MachZehnderModulator, drive voltages and output planes of a run that is not read or written in place
+	vector<t_real> fieldRe, fieldIm;
+
+	void putMachZehnder(int process);
+
  public:
 
 	 /* Input Parameters */
@@ -20,6 +32,12 @@ class IqModulator : public Block {
 	 double outputOpticalWavelength{ 1550e-9 };
 	 double outputOpticalFrequency{ SPEED_OF_LIGHT / outputOpticalWavelength };
 
+	 IqModulatorTransfer transfer{ LinearModulator };
+	 double vPi{ 1.0 };							// MachZehnderModulator, half-wave voltage of the child modulators, in the units of the drive signals
+	 double biasI{ 0.0 };						// MachZehnderModulator, bias offsets from the null point
+	 double biasQ{ 0.0 };
+	 double extinctionRatio_dB{ HUGE_VAL };		// MachZehnderModulator, extinction ratio of the child modulators
+
 	 /* Methods */
 
 	 IqModulator(vector<Signal *> &InputSig, vector<Signal *> &OutputSig) :Block(InputSig, OutputSig){};
@@ -31,6 +49,19 @@ class IqModulator : public Block {
 	 void setOutputOpticalPower_dBm(double outOpticalPower_dBm) { outputOpticalPower = 1e-3*pow(10, outOpticalPower_dBm / 10); }
 
 	 void setOutputOpticalWavelength(double outOpticalWavelength) { outputOpticalWavelength = outOpticalWavelength; outputOpticalFrequency = SPEED_OF_LIGHT / outOpticalWavelength; }
+	 void setTransfer(IqModulatorTransfer t) { transfer = t; }
+	 IqModulatorTransfer const getTransfer(void) { return transfer; }
+
+	 void setVPi(double v) { vPi = v; }
+	 double const getVPi(void) { return vPi; }
+
+	 void setBias(double bI, double bQ) { biasI = bI; biasQ = bQ; }
+	 double const getBiasI(void) { return biasI; }
+	 double const getBiasQ(void) { return biasQ; }
+
+	 void setExtinctionRatio_dB(double er_dB) { extinctionRatio_dB = er_dB; }
+	 double const getExtinctionRatio_dB(void) { return extinctionRatio_dB; }
+
 	 void setOutputOpticalFrequency(double outOpticalFrequency) { outputOpticalFrequency = outOpticalFrequency; outputOpticalWavelength = outOpticalFrequency / outputOpticalFrequency; }
 };
 
@@ -1,12 +1,32 @@
 # ifndef LASER_H_
 # define LASER_H_
 
+# include <cstdint>		// uint64_t
+# include <math.h>		// pow, HUGE_VAL
 # include "netplus.h"
+# include "random_generator.h"
 
+// Continuous-wave laser. The output field is sqrt(outputOpticalPower*(1 + d[k]))*exp(j*phi[k]), where phi is a Wiener process: phi[0] = initialPhase,
+// phi[k+1] = phi[k] + sqrt(2*pi*linewidth*samplingPeriod)*N(0,1), kept in [-pi, pi], and d is white relative intensity noise of
+// one-sided density rin_dB_Hz over the simulation bandwidth 1/samplingPeriod (variance 10^(rin_dB_Hz/10)/(2*samplingPeriod)), the power clipped at 0.
+// The Gaussian samples are drawn from the counter-based generator, 2k for the phase increment and 2k + 1 for the intensity of sample k,
+// so the output does not depend on the buffer lengths. The whole contiguous space of the output is filled on each run, through dspKernels().polar.
 class Laser : public Block {
 
 	// State variables
 
+	bool firstTime{ true };
+
+	CounterRng generator;
+	uint64_t sampleIndex{ 0 };			// next output sample
+	double phase{ 0 };					// phase of the next output sample
+
+	vector<t_real> gaussians;			// scratch arrays of one run
+	vector<t_real> magnitudes, phases;
+	vector<t_real> fieldRe, fieldIm;
+
+	void putSamples(int n);
+
  public:
 
 	 // Input parameters
@@ -15,16 +35,43 @@ class Laser : public Block {
 
 	 double samplingPeriod{ 1e-12 };
 
+	 double outputOpticalPower{ 1e-3 };
+	 double linewidth{ 0 };				// Hz, 0 for no phase noise
+	 double rin_dB_Hz{ -HUGE_VAL };		// relative intensity noise, -HUGE_VAL for none
+
+	 long long numberOfSamples{ -1 };	// -1 for an endless output
+
+	 long long seed{ -1 };				// seed of the noise, -1 for the run seed (see setRunSeed())
+	 long long streamId{ -1 };			// stream of the noise, -1 for a stream of its own (newDefaultStream())
+
 	// Methods
 	Laser(vector<Signal *> &InputSig, vector<Signal *> &OutputSig);
-	
+
+	void initialize(void);
 	bool runBlock(void);
 
 	void setCentralWavelength(double cWavelength) { centralWavelength = cWavelength; };
 	void setInitialPhase(double iPhase) { initialPhase = iPhase; };
 	void setSamplingPeriod(double sampPeriod) {  samplingPeriod = sampPeriod; };
-};
 
-# endif
+	void setOutputOpticalPower(double outOpticalPower) { outputOpticalPower = outOpticalPower; };
+	void setOutputOpticalPower_dBm(double outOpticalPower_dBm) { outputOpticalPower = 1e-3*pow(10, outOpticalPower_dBm / 10); };
+	double const getOutputOpticalPower(void) { return outputOpticalPower; };
+
+	void setLinewidth(double lw) { linewidth = lw; };
+	double const getLinewidth(void) { return linewidth; };
+
+	void setRin_dB_Hz(double rin) { rin_dB_Hz = rin; };
+	double const getRin_dB_Hz(void) { return rin_dB_Hz; };
 
+	void setNumberOfSamples(long long nOfSamples) { numberOfSamples = nOfSamples; };
+	long long const getNumberOfSamples(void) { return numberOfSamples; };
 
+	void setSeed(long long s) { seed = s; };
+	long long const getSeed(void) { return seed; };
+
+	void setStreamId(long long id) { streamId = id; };
+	long long const getStreamId(void) { return streamId; };
+};
+
+# endif
@@ -0,0 +1,66 @@
+# ifndef LUT_PULSE_SHAPER_H_
+# define LUT_PULSE_SHAPER_H_
+
+# include <vector>
+# include "netplus.h"
+# include "polyphase_pulse_shaper.h"
+
+using namespace std;
+
+/* Table look-up pulse shaper for symbols drawn from a finite alphabet (the I or the Q levels of a M-QAM constellation).
+For every polyphase branch the symbol window is split in groups of symbolsPerGroup consecutive symbols, and the partial waveform
+of every possible group is precomputed. Each output sample is then the sum of one table entry per group.
+symbolsPerGroup is the largest value for which the whole table fits in lookUpTableMaxSize bytes (by default, a typical L2 cache).
+Symbols that do not belong to the alphabet are still shaped correctly, using the polyphase dot product.
+If no alphabet is given, or if the input signal is complex or fixed-point, the block behaves as a PolyphasePulseShaper.
+INPUT PARAMETERS:
+vector<t_real> alphabet{ };
+int lookUpTableMaxSize{ 256 * 1024 };
+*/
+class LutPulseShaper : public PolyphasePulseShaper {
+
+	/* State Variables */
+
+	vector<t_real> valueHistory;						// last symbolsPerWindow symbols, stored twice to be read as a contiguous window
+	vector<int> indexHistory;							// alphabet index of the symbols in valueHistory, -1 if the symbol is not in the alphabet
+	int historyPosition{ 0 };
+	int phase{ 0 };
+	int unknownSymbols{ 0 };							// number of symbols in the window that are not in the alphabet
+
+	vector<int> groupIndex;								// table entry of each group for the current window
+
+	/* Input Parameters */
+
+	vector<t_real> alphabet;
+
+	int lookUpTableMaxSize{ 256 * 1024 };				// in bytes
+
+public:
+
+	/* State Variables */
+
+	int symbolsPerGroup{ 1 };
+	int numberOfGroups{ 0 };
+	int symbolsPerWindow{ 0 };							// numberOfGroups * symbolsPerGroup >= numberOfTapsPerPhase
+	int groupTableSize{ 0 };							// alphabet.size() ^ symbolsPerGroup
+
+	vector<t_real> windowTaps;							// polyphaseTaps padded at the oldest end to symbolsPerWindow taps per branch
+	vector<t_real> lookUpTable;							// numberOfSamplesPerSymbol x numberOfGroups x groupTableSize partial sums
+
+	/* Methods */
+
+	LutPulseShaper(vector<Signal *> &InputSig, vector<Signal *> &OutputSig) :PolyphasePulseShaper(InputSig, OutputSig){};
+
+	void initialize(void);
+
+	bool runBlock(void);
+
+	void setAlphabet(vector<t_real> symbolAlphabet);	// repeated values are removed
+	vector<t_real> const getAlphabet(void){ return alphabet; };
+
+	void setLookUpTableMaxSize(int maxSize){ lookUpTableMaxSize = maxSize; };
+	int const getLookUpTableMaxSize(void){ return lookUpTableMaxSize; };
+
+};
+
+# endif
@@ -5,6 +5,8 @@
 # include <math.h>       // log2 
 
 # include "netplus.h"
+# include "fixed_point.h"
+# include "dsp_kernels.h"
 
 using namespace std;
 
@@ -13,13 +15,40 @@ struct t_iqValues {
 	t_real q;
 };
 
-/* Realizes the M-QAM mapping. */
+const int MAX_M_QAM = 1024;	// Largest constellation generated by setM
+
+/* Gray labelled M-QAM constellation with unit average power, M = 2^n from 2 to MAX_M_QAM. The first ceil(n/2) bits of a label select
+the I level and the last floor(n/2) the Q level, both Gray coded. For even n the constellation is square; for odd n it is rectangular
+(n < 5) or a cross, obtained by folding the outer I columns of the 2^((n+1)/2) x 2^((n-1)/2) rectangle to the top and bottom rows,
+so that only the labels of the folded points lose the Gray property. */
+vector<t_iqValues> grayQamConstellation(int m);
+
+/* Realizes the M-QAM mapping. With two real output signals the I and Q amplitudes are written in separate signals,
+with one complex output signal each symbol is written as a t_complex value. With fixed-point output signals the I and Q amplitudes
+are written as codes of outputFixedPointFormat. The log2(m) bits of each symbol, the most significant first, are its index in iqAmplitudes;
+setM selects the grayQamConstellation of order m, setIqAmplitudes any other constellation of 2^n points. The square Gray constellations
+used in production (m = 4, 16 and 64) are mapped in bulk by the compile-time kernels of dsp_kernels.h, with real or complex floating-point
+outputs; the other cases use the tables. */
 class MQamMapper : public Block {
 
 	/* State Variables */
 
-	t_integer auxBinaryValue{ 0 };
-	t_integer auxSignalNumber{ 0 };
+	t_integer auxBinaryValue{ 0 };				// bits of the current symbol already read
+	t_integer auxSignalNumber{ 0 };				// index of the current symbol, from those bits
+
+	bool complexOutput{ false };
+	bool fixedPointOutput{ false };
+
+	int bitsPerSymbol{ 2 };
+	vector<t_complex> complexTable;				// iqAmplitudes as t_complex values
+	vector<t_fixed> fixedTable;					// iqAmplitudes as outputFixedPointFormat codes, I and Q interleaved
+
+	t_real grayScale{ 1.0 };					// scale of grayQamConstellation(m), for the mapping kernels
+	QamMapperKernel mapperKernel{ nullptr };	// compile-time kernels of QPSK, 16-QAM and 64-QAM, nullptr otherwise
+	ComplexQamMapperKernel complexMapperKernel{ nullptr };
+
+	void putBit(t_binary bit);					// shifts a bit into the current symbol, and outputs it when complete
+	int symbolSpace(void);						// symbols that can be written contiguously in the output signals
 
 
 public:
@@ -29,18 +58,23 @@ public:
 	t_integer m{ 4 };
 	vector<t_iqValues> iqAmplitudes;
 
+	FixedPointFormat outputFixedPointFormat{ 3, 12 };
+
 
 	/* Methods */
 
-	MQamMapper(vector<Signal *> &InputSig, vector<Signal *> &OutputSig) :Block(InputSig, OutputSig) {};
+	MQamMapper(vector<Signal *> &InputSig, vector<Signal *> &OutputSig) :Block(InputSig, OutputSig) { setM(m); };
 
 	void initialize(void);
 
 	bool runBlock(void);
 
-	void setM(int mValue);		// m should be of the form m = 2^n, with n integer;
+	void setM(int mValue);		// m should be of the form m = 2^n, with n integer, up to MAX_M_QAM
+
+	void setIqAmplitudes(vector<t_iqValues> iqAmplitudesValues);	// the number of points must be a power of 2, otherwise it is ignored
 
-	void setIqAmplitudes(vector<t_iqValues> iqAmplitudesValues);
+	void setOutputFixedPointFormat(FixedPointFormat format){ outputFixedPointFormat = format; };
+	FixedPointFormat const getOutputFixedPointFormat(void){ return outputFixedPointFormat; };
 
 };
 
@@ -4,12 +4,15 @@
 # include "netplus.h"
 # include "binary_source.h"
 # include "m_qam_mapper.h"
-# include "discrete_to_continuous_time.h"
-# include "pulse_shaper.h"
+# include "lut_pulse_shaper.h"
 # include "iq_modulator.h"
 
 //using namespace std;
 
+/* JointIq: the mapper writes complex symbols and a single pulse shaper filters I and Q together.
+SeparateIq: I and Q are mapped, shaped and saved as independent real signals (e.g. for I/Q imbalance studies). */
+enum IqPulseShaping { JointIq, SeparateIq };
+
 
 class MQamTransmitter : public SuperBlock {
 
@@ -25,15 +28,17 @@ class MQamTransmitter : public SuperBlock {
 
 	TimeDiscreteAmplitudeDiscreteReal S3{ "MQAM3.sgn" };
 
-	TimeContinuousAmplitudeDiscreteReal S4{ "MQAM4.sgn" };
+	TimeContinuousAmplitudeContinuousReal S4{ "MQAM4.sgn" };
+
+	TimeContinuousAmplitudeContinuousReal S5{ "MQAM5.sgn" };
 
-	TimeContinuousAmplitudeDiscreteReal S5{ "MQAM5.sgn" };
+	BandpassSignal S6{ "MQAM6.sgn" };
 
-	TimeContinuousAmplitudeContinuousReal S6{ "MQAM6.sgn" };
+	TimeDiscreteAmplitudeDiscreteComplex S7{ "MQAM7.sgn" };
 
-	TimeContinuousAmplitudeContinuousReal S7{ "MQAM7.sgn" };
+	TimeContinuousAmplitudeContinuousComplex S8{ "MQAM8.sgn" };
 
-	BandpassSignal S8{ "MQAM8.sgn" };
+	BandpassSignal S9{ "MQAM9.sgn" };
 
 
 	// #####################################################################################################
@@ -45,31 +50,39 @@ class MQamTransmitter : public SuperBlock {
 
 	MQamMapper B2{ vector<Signal*> { &S1 }, vector<Signal*> { &S2, &S3 } };
 
-	DiscreteToContinuousTime B3{ vector<Signal*> { &S2 }, vector<Signal*> { &S4 } };
+	LutPulseShaper B3{ vector<Signal*> { &S2 }, vector<Signal*> { &S4 } };
+
+	LutPulseShaper B4{ vector<Signal*> { &S3 }, vector<Signal*> { &S5 } };
 
-	DiscreteToContinuousTime B4{ vector<Signal*> { &S3 }, vector<Signal*> { &S5 } };
+	IqModulator B5{ vector<Signal*> { &S4, &S5 }, vector<Signal*> { &S6 } };
 
-	PulseShaper B5{ vector<Signal*> { &S4 }, vector<Signal*> { &S6 } };
+	MQamMapper B6{ vector<Signal*> { &S1 }, vector<Signal*> { &S7 } };
 
-	PulseShaper B6{ vector<Signal*> { &S5 }, vector<Signal*> { &S7 } };
+	PolyphasePulseShaper B7{ vector<Signal*> { &S7 }, vector<Signal*> { &S8 } };
 
-	IqModulator B7{ vector<Signal*> { &S6, &S7 }, vector<Signal*> { &S8 } };
+	IqModulator B8{ vector<Signal*> { &S8 }, vector<Signal*> { &S9 } };
 
 
 
 	/* Input Parameters */
 
+	IqPulseShaping iqPulseShaping{ JointIq };
 
 public:
 
 	/* Methods */
 
-	MQamTransmitter(vector<Signal *> &inputSignal, vector<Signal *> &outputSignal):SuperBlock(inputSignal, outputSignal){ setModuleBlocks({ &B1, &B2, &B3, &B4, &B5, &B6, &B7 }); };
+	MQamTransmitter(vector<Signal *> &inputSignal, vector<Signal *> &outputSignal):SuperBlock(inputSignal, outputSignal){ setIqPulseShaping(iqPulseShaping); };
+
+	void initialize(void);
 
 	/* Set Methods */
 
 	void set(int opt);
 
+	void setIqPulseShaping(IqPulseShaping iqShaping);
+	IqPulseShaping const getIqPulseShaping(void) { return iqPulseShaping; };
+
 	void setMode(BinarySourceMode m) { B1.setMode(m); };
 	BinarySourceMode const getMode(void) { return B1.getMode(); };
 
@@ -79,6 +92,15 @@ public:
 	void setBitStream(string bStream) { B1.setBitStream(bStream); };
 	string const getBitStream(void) { return B1.getBitStream(); };
 
+	void setBitFileName(string fName) { B1.setBitFileName(fName); };
+	string const getBitFileName(void) { return B1.getBitFileName(); };
+
+	void setBitFileFormat(BitFileFormat fFormat) { B1.setBitFileFormat(fFormat); };
+	BitFileFormat const getBitFileFormat(void) { return B1.getBitFileFormat(); };
+
+	void setBitFileLoop(bool fLoop) { B1.setBitFileLoop(fLoop); };
+	bool const getBitFileLoop(void) { return B1.getBitFileLoop(); };
+
 	void setNumberOfBits(long int nOfBits) { B1.setNumberOfBits(nOfBits); }
 	long int const getNumberOfBits(void) { return B1.getNumberOfBits();  }
 
@@ -88,26 +110,38 @@ public:
 	void setBitPeriod(double bPeriod) {B1.setBitPeriod(bPeriod);};
 	double const getBitPeriod(void) { return B1.getBitPeriod(); }
 
-	void setM(int mValue){B2.m = mValue;};
+	void setBitOffset(long long bOffset) { B1.setBitOffset(bOffset); };
+	long long const getBitOffset(void) { return B1.getBitOffset(); }
+
+	void setSeed(long long s) { B1.setSeed(s); };
+	long long const getSeed(void) { return B1.getSeed(); }
+
+	void setStreamId(long long sId) { B1.setStreamId(sId); };
+	long long const getStreamId(void) { return B1.getStreamId(); }
+
+	void setM(int mValue){ B2.setM(mValue); B6.setM(mValue); };
 	int const getM(void) { return B2.m; };
 
-	void setIqAmplitudes(vector<t_iqValues> iqAmplitudesValues){ B2.m = iqAmplitudesValues.size(); B2.iqAmplitudes.resize(B2.m); B2.iqAmplitudes = iqAmplitudesValues; };
+	void setIqAmplitudes(vector<t_iqValues> iqAmplitudesValues){ B2.setIqAmplitudes(iqAmplitudesValues); B6.setIqAmplitudes(iqAmplitudesValues); };
 	vector<t_iqValues> const getIqAmplitudes(void){ return B2.iqAmplitudes; };
 
-	void setNumberOfSamplesPerSymbol(int n){ B3.setNumberOfSamplesPerSymbol(n); B4.setNumberOfSamplesPerSymbol(n); };
+	void setNumberOfSamplesPerSymbol(int n){ B3.setNumberOfSamplesPerSymbol(n); B4.setNumberOfSamplesPerSymbol(n); B7.setNumberOfSamplesPerSymbol(n); };
 	int const getNumberOfSamplesPerSymbol(void){ return B3.getNumberOfSamplesPerSymbol(); };
 
-	void setRollOffFactor(double rOffFactor){ B5.setRollOffFactor(rOffFactor); B6.setRollOffFactor(rOffFactor); };
-	double const getRollOffFactor(void){ return B5.getRollOffFactor(); };
+	void setRollOffFactor(double rOffFactor){ B3.setRollOffFactor(rOffFactor); B4.setRollOffFactor(rOffFactor); B7.setRollOffFactor(rOffFactor); };
+	double const getRollOffFactor(void){ return B3.getRollOffFactor(); };
+
+	void setLookUpTableMaxSize(int maxSize){ B3.setLookUpTableMaxSize(maxSize); B4.setLookUpTableMaxSize(maxSize); };
+	int const getLookUpTableMaxSize(void){ return B3.getLookUpTableMaxSize(); };
 
-	void setSeeBeginningOfImpulseResponse(bool sBeginningOfImpulseResponse){ B5.setSeeBeginningOfImpulseResponse(sBeginningOfImpulseResponse); B6.setSeeBeginningOfImpulseResponse(sBeginningOfImpulseResponse); };
-	double const getSeeBeginningOfImpulseResponse(void){ return B5.getSeeBeginningOfImpulseResponse(); };
+	void setSeeBeginningOfImpulseResponse(bool sBeginningOfImpulseResponse){ B3.setSeeBeginningOfImpulseResponse(sBeginningOfImpulseResponse); B4.setSeeBeginningOfImpulseResponse(sBeginningOfImpulseResponse); B7.setSeeBeginningOfImpulseResponse(sBeginningOfImpulseResponse); };
+	double const getSeeBeginningOfImpulseResponse(void){ return B3.getSeeBeginningOfImpulseResponse(); };
 
-	void setOutputOpticalPower(t_real outOpticalPower) { B7.outputOpticalPower = outOpticalPower; };
-	t_real const getOutputOpticalPower(void) { return B7.outputOpticalPower; };
+	void setOutputOpticalPower(t_real outOpticalPower) { B5.outputOpticalPower = outOpticalPower; B8.outputOpticalPower = outOpticalPower; };
+	t_real const getOutputOpticalPower(void) { return B5.outputOpticalPower; };
 
-	void setOutputOpticalPower_dBm(t_real outOpticalPower_dBm) { B7.outputOpticalPower = 1e-3*pow(10, outOpticalPower_dBm / 10); };
-	t_real const getOutputOpticalPower_dBm(void) { return 10*log10(B7.outputOpticalPower/1e-3); }
+	void setOutputOpticalPower_dBm(t_real outOpticalPower_dBm) { setOutputOpticalPower(1e-3*pow(10, outOpticalPower_dBm / 10)); };
+	t_real const getOutputOpticalPower_dBm(void) { return 10*log10(B5.outputOpticalPower/1e-3); }
 
 };
 
@@ -13,10 +13,37 @@ using namespace std;
 
 typedef unsigned int t_binary;
 typedef int t_integer;
+// Sample scalar type. Building with NETPLUS_SINGLE_PRECISION defined runs the whole simulation in float, which halves the memory
+// traffic and doubles the SIMD width; the signal files record the precision in their header.
+# ifdef NETPLUS_SINGLE_PRECISION
+typedef float t_real;
+const char REAL_PRECISION[] = "single";
+# else
 typedef double t_real;
-typedef complex<double> t_complex;
+const char REAL_PRECISION[] = "double";
+# endif
+typedef complex<t_real> t_complex;
+typedef short t_fixed;		// Two's complement fixed-point code, see fixed_point.h
+
+// Dual-polarization sample: the complex envelopes of the X and Y polarizations, stored together so that a sample is read with one load.
+struct t_complex_xy {
+	t_complex x;
+	t_complex y;
+};
+
+// Jones matrix [xx xy; yx yy] of a polarization element, (x, y) -> (xx x + xy y, yx x + yy y). The diagonal is stored first, so that
+// the kernels load (xx, yy) and (xy, yx) straight into vectors (see dspKernels().jonesMatrix).
+struct t_jones {
+	t_complex xx;
+	t_complex yy;
+	t_complex xy;
+	t_complex yx;
+};
 
-enum signal_value_type {BinaryValue, IntegerValue, RealValue, ComplexValue};
+enum signal_value_type {BinaryValue, IntegerValue, RealValue, ComplexValue, FixedPointValue, ComplexXYValue};
+
+// Buffer layout of the complex signals: t_complex values, or a plane with the real parts followed by a plane with the imaginary parts.
+enum ComplexLayout { Interleaved, SplitPlanes };
 
 const int MAX_NAME_SIZE = 256;  // Maximum size of names
 const long int MAX_Sink_LENGTH = 100000;  // Maximum Sink Block number of values
@@ -25,6 +52,7 @@ const int MAX_TOPOLOGY_SIZE = 100;  // Maximum System topology size
 const int MAX_TAPS = 1000;  // Maximum Taps Number
 const double PI = 3.1415926535897932384;
 const double SPEED_OF_LIGHT = 299792458;
+const double PLANCK_CONSTANT = 6.62607015e-34;
 
 
 //########################################################################################################################################################
@@ -58,6 +86,7 @@ public:
 	long int count;									// Number of values that have already entered in the buffer
 
 	void *buffer{ NULL };							// Pointer to buffer
+	ComplexLayout complexLayout{ Interleaved };		// Complex signals: buffer layout, the files are always interleaved
 
 	int bufferLength{ 512 };						// Buffer length
 
@@ -68,6 +97,9 @@ public:
 	double centralWavelength{ 1550E-9 };
 	double centralFrequency{ SPEED_OF_LIGHT / centralWavelength };
 
+	int integerBits{ 0 };							// Fixed-point signals: integer bits, the sign bit not included
+	int fractionBits{ 15 };							// Fixed-point signals: fraction bits, the code of the value v is v * 2^fractionBits
+
 
 	/* Methods */
 
@@ -80,6 +112,9 @@ public:
 	~Signal(){ delete buffer; };					// Signal destructor
 
 	void close();									// Empty the signal buffer and close the signal file
+	void saveBuffer();								// Appends the full buffer to the signal file, from firstValueToBeSaved on
+	void writeValues(ofstream &fileHandler, int first, int last);	// Writes the values [first, last) of the buffer, complex values interleaved
+	int valueSize();								// Size of one value in the signal file, in bytes
 	int space();									// Returns the signal buffer space
 	int ready();									// Returns the number of samples in the buffer ready to be processed
 	void writeHeader();								// Opens the signal file in the default signals directory, \signals, and writes the signal header
@@ -88,33 +123,63 @@ public:
 	template<typename T>							// Puts a value in the buffer
 	void bufferPut(T value) {
 		(static_cast<T *>(buffer))[inPosition] = value;
+		commitPut(1);
+	};
+
+	void bufferPut(t_complex value) {				// Puts a complex value in the buffer, in either layout
+		if (complexLayout == SplitPlanes) {
+			realPlane()[inPosition] = value.real();
+			imagPlane()[inPosition] = value.imag();
+		}
+		else {
+			(static_cast<t_complex *>(buffer))[inPosition] = value;
+		}
+		commitPut(1);
+	};
+
+	/* Block access to the buffer: a block can write (read) up to contiguousSpace() (contiguousReady()) values directly in the buffer,
+	from inPosition (outPosition) on, and then call commitPut(n) (commitGet(n)). */
+	int contiguousSpace() { return min(space(), bufferLength - inPosition); };
+	int contiguousReady() { return min(ready(), bufferLength - outPosition); };
+
+	void commitPut(int n) {
+		if (n <= 0) return;
 		if (bufferEmpty) bufferEmpty = false;
-		inPosition++;
-		if (inPosition == bufferLength) { 
-			inPosition = 0; 
-			if (saveSignal) {
-				if (firstValueToBeSaved <= bufferLength) {
-					char *ptr = (char *) buffer;
-					ptr = ptr + (firstValueToBeSaved - 1)*sizeof(T);
-					ofstream fileHandler("./" + folderName + "/" + fileName, ios::out | ios::binary | ios::app);
-					int auxSizeOf = sizeof(T);
-					fileHandler.write(ptr, (bufferLength - (firstValueToBeSaved - 1 ))* sizeof(T));
-					fileHandler.close();
-					firstValueToBeSaved = 1;
-				}
-				else {
-					firstValueToBeSaved = firstValueToBeSaved - bufferLength;
-				}
-			}
+		inPosition = inPosition + n;
+		if (inPosition == bufferLength) {
+			inPosition = 0;
+			if (saveSignal) saveBuffer();
 		}
 		if (inPosition == outPosition) bufferFull = true;
 	};
 
+	void commitGet(int n) {
+		if (n <= 0) return;
+		if (bufferFull) bufferFull = false;
+		outPosition = outPosition + n;
+		if (outPosition == bufferLength) outPosition = 0;
+		if (outPosition == inPosition) bufferEmpty = true;
+	};
+
+	int skip(int n) {								// Discards up to n values without reading them, in O(1), returns the number discarded
+		n = min(n, ready());
+		if (n <= 0) return 0;
+		bufferFull = false;
+		outPosition = (outPosition + n) % bufferLength;
+		if (outPosition == inPosition) bufferEmpty = true;
+		return n;
+	};
+
+	t_real *realPlane() { return static_cast<t_real *>(buffer); };					// SplitPlanes layout, real parts
+	t_real *imagPlane() { return static_cast<t_real *>(buffer) + bufferLength; };	// SplitPlanes layout, imaginary parts
+
 	void virtual bufferGet();
 	void virtual bufferGet(t_binary *valueAddr);
 	void virtual bufferGet(t_integer *valueAddr);
 	void virtual bufferGet(t_real *valueAddr);
 	void virtual bufferGet(t_complex *valueAddr);
+	void virtual bufferGet(t_fixed *valueAddr);
+	void virtual bufferGet(t_complex_xy *valueAddr);
 	
 	void setSaveSignal(bool sSignal){ saveSignal = sSignal; };
 	bool const getSaveSignal(){ return saveSignal; };
@@ -156,6 +221,13 @@ public:
 	void setCentralWavelength(double cWavelength){ centralWavelength = cWavelength; centralFrequency = SPEED_OF_LIGHT / centralWavelength; }
 	double getCentralWavelength(){ return centralWavelength; }
 
+	void setComplexLayout(ComplexLayout layout) { complexLayout = layout; };	// Both layouts use the same buffer, it can be changed before the simulation starts
+	ComplexLayout getComplexLayout(){ return complexLayout; };
+
+	void setFixedPointFormat(int iBits, int fBits) { integerBits = iBits; fractionBits = fBits; };
+	int getIntegerBits(){ return integerBits; };
+	int getFractionBits(){ return fractionBits; };
+
 };
 
 
@@ -192,8 +264,19 @@ public:
 class TimeDiscreteAmplitudeDiscreteComplex : public TimeDiscreteAmplitudeDiscrete {
 	
 public:
-	TimeDiscreteAmplitudeDiscreteComplex(string fName) { setFileName(fName); }
-	TimeDiscreteAmplitudeDiscreteComplex() {}
+	TimeDiscreteAmplitudeDiscreteComplex(string fName) { setType("TimeDiscreteAmplitudeDiscreteComplex", ComplexValue); setFileName(fName); if (buffer == nullptr) buffer = new t_complex[bufferLength]; }
+	TimeDiscreteAmplitudeDiscreteComplex(string fName, int bLength) { setType("TimeDiscreteAmplitudeDiscreteComplex", ComplexValue); setFileName(fName); setBufferLength(bLength); if (buffer == nullptr) buffer = new t_complex[bLength]; }
+	TimeDiscreteAmplitudeDiscreteComplex(int bLength) { setType("TimeDiscreteAmplitudeDiscreteComplex", ComplexValue); setBufferLength(bLength); if (buffer == nullptr) buffer = new t_complex[bLength]; }
+	TimeDiscreteAmplitudeDiscreteComplex() { setType("TimeDiscreteAmplitudeDiscreteComplex", ComplexValue); if (buffer == nullptr) buffer = new t_complex[bufferLength]; }
+};
+
+
+class TimeDiscreteAmplitudeDiscreteFixedPoint : public TimeDiscreteAmplitudeDiscrete {
+public:
+	TimeDiscreteAmplitudeDiscreteFixedPoint(string fName) { setType("TimeDiscreteAmplitudeDiscreteFixedPoint", FixedPointValue); setFileName(fName); if (buffer == nullptr) buffer = new t_fixed[bufferLength]; }
+	TimeDiscreteAmplitudeDiscreteFixedPoint(string fName, int bLength) { setType("TimeDiscreteAmplitudeDiscreteFixedPoint", FixedPointValue); setFileName(fName); setBufferLength(bLength); if (buffer == nullptr) buffer = new t_fixed[bLength]; }
+	TimeDiscreteAmplitudeDiscreteFixedPoint(int bLength) { setType("TimeDiscreteAmplitudeDiscreteFixedPoint", FixedPointValue); setBufferLength(bLength); if (buffer == nullptr) buffer = new t_fixed[bLength]; }
+	TimeDiscreteAmplitudeDiscreteFixedPoint() { setType("TimeDiscreteAmplitudeDiscreteFixedPoint", FixedPointValue); if (buffer == nullptr) buffer = new t_fixed[bufferLength]; }
 };
 
 
@@ -264,6 +347,15 @@ public:
 };
 
 
+class TimeContinuousAmplitudeDiscreteFixedPoint : public TimeContinuousAmplitudeDiscrete {
+public:
+	TimeContinuousAmplitudeDiscreteFixedPoint(string fName) { setType("TimeContinuousAmplitudeDiscreteFixedPoint", FixedPointValue); setFileName(fName); if (buffer == nullptr) buffer = new t_fixed[bufferLength]; }
+	TimeContinuousAmplitudeDiscreteFixedPoint(string fName, int bLength) { setType("TimeContinuousAmplitudeDiscreteFixedPoint", FixedPointValue); setFileName(fName); setBufferLength(bLength); if (buffer == nullptr) buffer = new t_fixed[bLength]; }
+	TimeContinuousAmplitudeDiscreteFixedPoint(int bLength) { setType("TimeContinuousAmplitudeDiscreteFixedPoint", FixedPointValue); setBufferLength(bLength); if (buffer == nullptr) buffer = new t_fixed[bLength]; }
+	TimeContinuousAmplitudeDiscreteFixedPoint(){ setType("TimeContinuousAmplitudeDiscreteFixedPoint", FixedPointValue); if (buffer == nullptr) buffer = new t_fixed[bufferLength]; }
+};
+
+
 class TimeContinuousAmplitudeContinuousReal : public TimeContinuousAmplitudeContinuous {
 public:
 	TimeContinuousAmplitudeContinuousReal(string fName) { setType("TimeContinuousAmplitudeContinuousReal", RealValue); setFileName(fName); if (buffer == nullptr) buffer = new t_real[bufferLength]; }
@@ -291,6 +383,15 @@ public:
 
 };
 
+// Dual-polarization BandpassSignal, one t_complex_xy per sample; the buffer is always Interleaved.
+class BandpassSignalXY : public TimeContinuousAmplitudeContinuous {
+public:
+	BandpassSignalXY(string fName) { setType("BandpassSignalXY", ComplexXYValue); setFileName(fName); if (buffer == nullptr) buffer = new t_complex_xy[bufferLength]; }
+	BandpassSignalXY(string fName, int bLength) { setType("BandpassSignalXY", ComplexXYValue); setFileName(fName); setBufferLength(bLength); if (buffer == nullptr) buffer = new t_complex_xy[bLength]; }
+	BandpassSignalXY(int bLength) { setType("BandpassSignalXY", ComplexXYValue); setBufferLength(bLength); if (buffer == nullptr) buffer = new t_complex_xy[bLength]; }
+	BandpassSignalXY(){ setType("BandpassSignalXY", ComplexXYValue); if (buffer == nullptr) buffer = new t_complex_xy[bufferLength]; }
+};
+
 class MultiModeBandpassSignal : BandpassSignal {
 public:
 	MultiModeBandpassSignal(int nBandpassSignals) {
@@ -319,6 +420,9 @@ class Block {
 	vector<Signal *> inputSignals;
 	vector<Signal *> outputSignals;
 
+	/* State Variables */
+	bool inputEnded{ false };		// set by endInput()
+
 	/* Methods */
 	Block(){};
 	Block(vector<Signal*> &InputSig, vector<Signal*> &OutputSig);
@@ -330,6 +434,8 @@ class Block {
 
 	void terminateBlock();
 	virtual void terminate(void){};
+
+	virtual void endInput(void) { inputEnded = true; };		// the blocks before it have output all their samples, so it outputs the ones it holds back
 	
 };
 
@@ -339,6 +445,7 @@ class SuperBlock : public Block {
 	/* State Variables */
 
 	vector<Block*> moduleBlocks;
+	unsigned int endedBlocks{ 0 };			// module blocks already told that their input ended
 
 	/* Input Parameters */
 
@@ -396,9 +503,14 @@ public:
 
 	void terminate(void){};
 
+	virtual void writeImpulseResponse(void);		// Saves the impulse response in the signals folder
+
 	void setSaveImpulseResponse(bool sImpulseResponse) { saveImpulseResponse = sImpulseResponse; };
 	bool getSaveImpulseResponse(void){ return saveImpulseResponse; };
 
+	void setImpulseResponseFilename(string fName) { impulseResponseFilename = fName; };
+	string getImpulseResponseFilename(void){ return impulseResponseFilename; };
+
 	void setImpulseResponseLength(int iResponseLength) { impulseResponseLength = iResponseLength; };
 	int const getImpulseResponseLength(){ return impulseResponseLength; }
 
@@ -409,7 +521,7 @@ public:
 
 
 
-// Generates a complex signal knowing the real part and the complex part.
+// Generates a complex signal knowing the real part and the complex part. The output signal can use either complex layout.
 class RealToComplex : public Block {
  public:
 	 RealToComplex(vector<Signal *> &InputSig, vector<Signal *> &OutputSig);
@@ -440,6 +552,7 @@ class System {
   void terminate();										
   void run();
   void run(string signalPath);
+  void drain();  // runs the blocks again after the end of the input, until each one has output the samples it holds back
 
   string signalsFolder{ "signals" };
   char fileName[MAX_NAME_SIZE];  // Name of the file with system description (.sdf)
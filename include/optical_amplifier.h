@@ -0,0 +1,107 @@
+# ifndef OPTICAL_AMPLIFIER_H_
+# define OPTICAL_AMPLIFIER_H_
+
+# include <cstdint>		// uint64_t
+# include <math.h>		// pow
+# include "netplus.h"
+# include "random_generator.h"
+# include "overlap_save.h"
+
+enum AmplifierMode { NoiseLoading, GainControl, PowerControl };
+
+/* Optical amplifier, or noise loading, of a BandpassSignal: the output is sqrt(G) x[k] + n[k], with n complex white Gaussian noise of
+power spectral density N in the polarization of the signal, over the simulation bandwidth 1/samplingPeriod. By mode:
+	NoiseLoading, G = 1 and N such that the OSNR of the output, P / (noisePolarizations * N * referenceBandwidth), is osnr_dB, with P the
+	measured input power;
+	GainControl, G = gain_dB and the ASE of an amplifier of noise figure NF, N = (NF G - 1) h nu / 2;
+	PowerControl, G such that the signal output power G P is outputPower_dBm, and the ASE as in GainControl.
+The input is processed in windows of measurementLength samples: the mean power P of the first window sets G and N for the whole run, or
+with trackPower the power of each window sets them for that window, so that the noise follows slow changes of the signal power. Only the
+last window, at the end of the input (see endInput()), can be shorter than measurementLength. The noise of sample k is drawn from the
+counter-based generator, samples 2k and 2k + 1, so it does not depend on the buffer lengths; it is added with dspKernels().realScaleAdd.
+An amplifier chain is modeled with one block per amplifier, each one measuring the signal and the noise that reach it. */
+class OpticalAmplifier : public Block {
+
+	/* State Variables */
+
+	bool firstTime{ true };
+
+	CounterRng generator;
+	uint64_t sampleIndex{ 0 };			// first sample of the window
+
+	OverlapSaveBuffer<t_complex> window;	// one frame of measurementLength samples, without guard
+	vector<t_real> noise;
+
+	bool calibrated{ false };
+	double inputPower{ 0 };				// W, mean power of the window that set the gain and the noise
+	double gain{ 1 };
+	double noiseDensity{ 0 };			// W/Hz, in the polarization of the signal
+
+	void calibrate(double power);		// sets gain and noiseDensity for a mean input power
+	void amplify(int n);				// the first n samples of the window
+
+public:
+
+	/* Input Parameters */
+
+	AmplifierMode mode{ NoiseLoading };
+	double osnr_dB{ 20 };							// NoiseLoading
+	double referenceBandwidth{ 12.5e9 };			// Hz, 0.1 nm at 1550 nm
+	int noisePolarizations{ 2 };					// 2 for the OSNR of an optical spectrum analyzer, 1 for the noise of the signal polarization only
+	double gain_dB{ 20 };							// GainControl
+	double noiseFigure_dB{ 5 };						// GainControl and PowerControl
+	double outputPower_dBm{ 0 };					// PowerControl, signal power
+	int measurementLength{ 1 << 16 };				// samples
+	bool trackPower{ false };
+
+	long long seed{ -1 };							// seed of the noise, -1 for the run seed (see setRunSeed())
+	long long streamId{ -1 };						// stream of the noise, -1 for a stream of its own (newDefaultStream())
+
+	/* Methods */
+
+	OpticalAmplifier(vector<Signal *> &InputSig, vector<Signal *> &OutputSig);
+
+	void initialize(void);
+	bool runBlock(void);
+
+	void setMode(AmplifierMode m) { mode = m; };
+	AmplifierMode const getMode(void) { return mode; };
+
+	void setOsnr_dB(double osnr) { osnr_dB = osnr; };
+	double const getOsnr_dB(void) { return osnr_dB; };
+
+	void setReferenceBandwidth(double b) { referenceBandwidth = b; };
+	double const getReferenceBandwidth(void) { return referenceBandwidth; };
+
+	void setNoisePolarizations(int p) { noisePolarizations = p; };
+	int const getNoisePolarizations(void) { return noisePolarizations; };
+
+	void setGain_dB(double g) { gain_dB = g; };
+	double const getGain_dB(void) { return gain_dB; };
+
+	void setNoiseFigure_dB(double nf) { noiseFigure_dB = nf; };
+	double const getNoiseFigure_dB(void) { return noiseFigure_dB; };
+
+	void setOutputPower_dBm(double p) { outputPower_dBm = p; };
+	double const getOutputPower_dBm(void) { return outputPower_dBm; };
+
+	void setMeasurementLength(int n) { measurementLength = n; };
+	int const getMeasurementLength(void) { return measurementLength; };
+
+	void setTrackPower(bool t) { trackPower = t; };
+	bool const getTrackPower(void) { return trackPower; };
+
+	void setSeed(long long s) { seed = s; };
+	long long const getSeed(void) { return seed; };
+
+	void setStreamId(long long id) { streamId = id; };
+	long long const getStreamId(void) { return streamId; };
+
+	// Values set by the last measured window
+	double const getInputPower(void) { return inputPower; };											// W
+	double const getAppliedGain_dB(void) { return 10 * log10(gain); };
+	double const getNoiseDensity(void) { return noiseDensity; };										// W/Hz
+	double const getOutputOsnr_dB(void) { return 10 * log10(gain * inputPower / (noisePolarizations * noiseDensity * referenceBandwidth)); };	// noise of this amplifier only
+};
+
+# endif
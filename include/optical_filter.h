@@ -0,0 +1,129 @@
+# ifndef OPTICAL_FILTER_H_
+# define OPTICAL_FILTER_H_
+
+# include <vector>
+# include <memory>		// shared_ptr
+# include "netplus.h"
+# include "fft.h"
+# include "overlap_save.h"
+
+using namespace std;
+
+enum OpticalFilterType { NoFilter, GaussianFilter, SuperGaussianFilter, MeasuredFilter };
+
+/* Everything that sets the frequency response of an OpticalFilter, at frequencies f relative to the central frequency of the signal:
+	H(f) = 10^(-insertionLoss_dB/20) A(f - centerFrequencyOffset) exp(j(beta2/2 w^2 - beta3/6 w^3)), w = 2 pi f,
+with beta2 and beta3 the accumulated dispersion and dispersion slope at centralWavelength, as in FiberSpan, and the amplitude A
+	NoFilter, 1;
+	GaussianFilter and SuperGaussianFilter, exp(-ln(2)/2 (2f/bandwidth)^(2 order)), -3 dB at +-bandwidth/2, order 1 for GaussianFilter;
+	MeasuredFilter, the attenuation and the phase of the measured points, interpolated linearly in dB and radians between them and held
+	constant beyond the first and the last one. */
+struct OpticalFilterDesign {
+	OpticalFilterType filterType{ GaussianFilter };
+	double bandwidth{ 50e9 };								// Hz
+	int order{ 1 };
+	double centerFrequencyOffset{ 0 };						// Hz
+	double insertionLoss_dB{ 0 };
+	double accumulatedDispersion_ps_nm{ 0 };
+	double accumulatedDispersionSlope_ps_nm2{ 0 };
+	double centralWavelength{ 1550e-9 };					// m
+	vector<double> measuredFrequency;						// Hz, increasing
+	vector<double> measuredAttenuation_dB;
+	vector<double> measuredPhase;							// rad, empty for a zero phase
+
+	complex<double> response(double frequency) const;
+
+	bool operator<(const OpticalFilterDesign &other) const;
+};
+
+/* Immutable frequency response of an OpticalFilterDesign for overlap-save frames of frameSize samples of the given samplingPeriod: the
+response of each FFT bin, with the 1/frameSize of the inverse FFT, and the guard that holds the impulse response (impulseResponseGuard()),
+rounded up to whole symbols of samplesPerSymbol samples. It is computed once per process for each (design, sampling period, samples per symbol,
+fftSize, guardLength) and shared by all the filters that use it. */
+class OpticalFilterResponse {
+
+public:
+
+	int frameSize;
+	int guard;
+	vector<t_complex> response;
+	shared_ptr<const FftPlan> plan;
+
+	OpticalFilterResponse(const OpticalFilterDesign &design, double samplingPeriod, int samplesPerSymbol, int fftSize, int guardLength);
+};
+
+// Thread-safe access to the process-wide frequency response cache.
+shared_ptr<const OpticalFilterResponse> getOpticalFilterResponse(const OpticalFilterDesign &design, double samplingPeriod, int samplesPerSymbol, int fftSize, int guardLength);
+
+/* Linear optical filter: chromatic dispersion, a bandpass shape or a measured response, such as the passband of a wavelength selective
+switch, all applied together to the complex envelope of the input BandpassSignal by a single multiplication in the frequency domain.
+The signal is streamed by overlap-save frames of fftSize samples, each one holding 2*guard samples of the previous one, so the output is
+the exact linear filtering of the input, up to the truncation of the impulse response to the guard, delayed by guard samples
+(getDelay()); signals that fill the whole band may need a longer guardLength. At the end of the input (see endInput()) the last frame is
+zero-padded, so the output is as long as the input. */
+class OpticalFilter : public Block {
+
+	/* State Variables */
+
+	bool firstTime{ true };
+
+	shared_ptr<const OpticalFilterResponse> filter;
+	OverlapSaveBuffer<t_complex> frame;		// one frame
+
+public:
+
+	/* Input Parameters */
+
+	OpticalFilterDesign design;
+	string responseFileName{ "" };			// MeasuredFilter points, read at initialize() if not empty; without points the block outputs nothing
+	int fftSize{ 0 };						// power of 2, 0 to choose the smallest one of at least 8 times guard and 1024
+	int guardLength{ 0 };					// samples, 0 to derive the guard from the impulse response
+	int numberOfThreads{ 0 };				// threads of the workerPool() a large FFT is split across, 0 for all of them
+
+	/* Methods */
+
+	OpticalFilter(vector<Signal *> &InputSig, vector<Signal *> &OutputSig) :Block(InputSig, OutputSig){};
+
+	void initialize(void);
+	bool runBlock(void);
+
+	void setFilterType(OpticalFilterType fType) { design.filterType = fType; };
+	OpticalFilterType const getFilterType(void) { return design.filterType; };
+
+	void setBandwidth(double b) { design.bandwidth = b; };
+	double const getBandwidth(void) { return design.bandwidth; };
+
+	void setOrder(int o) { design.order = o; };
+	int const getOrder(void) { return design.order; };
+
+	void setCenterFrequencyOffset(double f) { design.centerFrequencyOffset = f; };
+	double const getCenterFrequencyOffset(void) { return design.centerFrequencyOffset; };
+
+	void setInsertionLoss_dB(double l) { design.insertionLoss_dB = l; };
+	double const getInsertionLoss_dB(void) { return design.insertionLoss_dB; };
+
+	void setAccumulatedDispersion_ps_nm(double d) { design.accumulatedDispersion_ps_nm = d; };
+	double const getAccumulatedDispersion_ps_nm(void) { return design.accumulatedDispersion_ps_nm; };
+
+	void setAccumulatedDispersionSlope_ps_nm2(double s) { design.accumulatedDispersionSlope_ps_nm2 = s; };
+	double const getAccumulatedDispersionSlope_ps_nm2(void) { return design.accumulatedDispersionSlope_ps_nm2; };
+
+	// Measured points, frequencies in Hz relative to the central frequency; phase may be empty.
+	void setMeasuredResponse(vector<double> frequency, vector<double> attenuation_dB, vector<double> phase = vector<double>());
+
+	// Text file of lines "frequency_GHz attenuation_dB [phase_rad]", lines starting with "//" are skipped.
+	void setResponseFileName(string fName) { responseFileName = fName; };
+	string const getResponseFileName(void) { return responseFileName; };
+
+	void setFftSize(int n) { fftSize = n; };
+	int const getFftSize(void) { return filter ? filter->frameSize : fftSize; };
+
+	void setGuardLength(int g) { guardLength = g; };
+
+	void setNumberOfThreads(int n) { numberOfThreads = n; };
+	int const getNumberOfThreads(void) { return numberOfThreads; };
+
+	int const getDelay(void) { return filter ? filter->guard : 0; };		// samples, valid after initialize()
+};
+
+# endif
@@ -0,0 +1,79 @@
+# ifndef OVERLAP_SAVE_H_
+# define OVERLAP_SAVE_H_
+
+# include <complex>
+# include <functional>
+# include <string>
+# include <vector>
+# include "netplus.h"
+
+using namespace std;
+
+// Energy of the impulse response left outside the guard of an overlap-save block, relative to the whole; the float FFT of a single
+// precision build cannot resolve less than about 1e-9.
+# ifdef NETPLUS_SINGLE_PRECISION
+const double FILTER_TRUNCATION = 1e-9;
+# else
+const double FILTER_TRUNCATION = 1e-12;
+# endif
+
+// Frequency of the bin k of an FFT of size points, the upper half of the bins holding the negative frequencies.
+double binFrequency(int k, int size, double samplingPeriod);
+
+// beta2 (s^2/m) and beta3 (s^3/m) of a dispersion (s/m^2) and a dispersion slope (s/m^3) at a wavelength (m); the dispersion phase of a
+// length L at the angular frequency w, relative to the central one, is (beta2/2 w^2 - beta3/6 w^3) L.
+void dispersionCoefficients(double dispersion, double dispersionSlope, double wavelength, double &beta2, double &beta3);
+
+/* Smallest guard holding all but FILTER_TRUNCATION of the energy of numberOfResponses impulse responses together, given by their
+frequency responses: response(f, h) writes the numberOfResponses values at the frequency f, relative to the central one. The responses
+are first tapered to zero over the outer fifth of the band: the jump of the group delay between the two edges of the band, where the
+spectrum wraps around, spreads a little energy over the whole frame, which only matters to signals that reach the edges. So the guard
+holds the impulse response for signals with no power above 0.8/(2 samplingPeriod), such as signals of 2 samples per symbol with a
+roll-off up to 0.6. The guard is found on a grid at least four times longer, so that the tails folded back by the FFT do not count;
+blockName prefixes the message when the grid reaches its largest size. */
+int impulseResponseGuard(const function<void(double, complex<double> *)> &response, int numberOfResponses, double samplingPeriod, string blockName);
+
+int symbolAlignedGuard(int guard, int samplesPerSymbol);		// guard rounded up to whole symbols, so that the output keeps the symbol timing
+int overlapSaveFrameSize(int fftSize, int guard);				// power of 2 of at least 4 times guard, fftSize if it is larger, 0 for at least 8 times guard and 1024
+
+/* Input and output samples of a block streamed by overlap-save frames of frameSize samples, each one holding, before its newSamples new
+samples, the last 2*guard samples of the previous one. read() fills a batch of batchFrames frames, the input of frame f starting at
+input(f); the block processes the frames into output(f), one frame of frameSize samples each, and advance(samples) queues the output
+samples [guard, guard + newSamples) of the frames processed and keeps the 2*guard samples that start the next frame. write() then
+outputs them, delayed by guard samples. The samples of a Signal are copied as they are, t_complex ones interleaved from and to
+SplitPlanes buffers with dspKernels().interleave and deinterleave. At the end of the input, padFrames() zero-pads the partial frame, and
+advance(filled()) then queues every sample read, so the output is as long as the input. */
+template<class T>
+class OverlapSaveBuffer {
+
+	vector<T> inputBatch;					// samples read, the first 2 * guard of them kept from the previous batch
+	int inputFilled{ 0 };
+	vector<T> outputBatch;					// processed frames
+	int outputSamples{ 0 };					// queued by the last advance()
+	int pendingSamples{ 0 };				// queued samples not yet written
+
+public:
+
+	int frameSize{ 0 };
+	int guard{ 0 };
+	int newSamples{ 0 };					// frameSize - 2 * guard
+	int batchFrames{ 0 };
+
+	void initialize(int fSize, int g, int frames = 1);	// the 2 * guard samples before the first frame are zero
+
+	int read(Signal *in);					// reads up to the end of the batch, returns the number read
+	int write(Signal *out);					// writes the pending samples, returns the number written
+
+	int filled(void) const { return inputFilled - 2 * guard; };		// new samples read
+	int frames(void) const { return filled() / newSamples; };		// whole frames read
+	bool full(void) const { return frames() == batchFrames; };
+	int pending(void) const { return pendingSamples; };
+
+	const T *input(int frame) const { return inputBatch.data() + (size_t) frame * newSamples; };
+	T *output(int frame) { return outputBatch.data() + (size_t) frame * frameSize; };
+
+	int padFrames(void);					// zero-pads the input after the last sample read up to the end of its frame, returns the frames to process
+	void advance(int samples);				// samples new samples processed, frames() * newSamples or, at the end of the input, filled()
+};
+
+# endif
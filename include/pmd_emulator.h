@@ -0,0 +1,86 @@
+# ifndef PMD_EMULATOR_H_
+# define PMD_EMULATOR_H_
+
+# include <cstdint>		// uint64_t
+# include <vector>
+# include <memory>		// shared_ptr
+# include "netplus.h"
+# include "fft.h"
+# include "random_generator.h"
+# include "overlap_save.h"
+
+using namespace std;
+
+/* First and higher order polarization mode dispersion of a BandpassSignalXY, by the waveplate model: numberOfSections birefringent
+sections of differential group delay tau = meanDgd sqrt(3 pi / (8 numberOfSections)) each, so that the mean DGD of the Maxwellian
+distribution is meanDgd, joined by random rotations uniform on the Poincare sphere. Section k is D(f) U_k, with D(f) =
+diag(exp(j pi f tau), exp(-j pi f tau)) and U_k drawn from the counter-based generator, samples 4k to 4k + 3, so a seed and a stream give
+the same fiber in every run. The product of all the sections is computed once per FFT bin, at initialize(), and applied to the spectra of
+the two polarizations by a single pass of dspKernels().jonesMatrices per frame; the frames are streamed by overlap-save, as in
+OpticalFilter, so the output is delayed by guard samples (getDelay()) and, with the last frame zero-padded at the end of the input, as
+long as the input. The guard holds the four impulse responses together (impulseResponseGuard()), rounded up to whole symbols. */
+class PmdEmulator : public Block {
+
+	/* State Variables */
+
+	bool firstTime{ true };
+
+	CounterRng generator;
+	vector<t_jones> rotations;				// U_k
+	double sectionDgd{ 0 };					// s
+
+	shared_ptr<const FftPlan> plan;
+	int frameSize{ 0 };
+	int guard{ 0 };
+	vector<t_jones> response;				// per FFT bin, with the 1/frameSize of the inverse FFT
+
+	OverlapSaveBuffer<t_complex_xy> frame;	// one frame
+	vector<t_complex> spectrumX, spectrumY;	// FFT of each polarization
+
+public:
+
+	/* Input Parameters */
+
+	int numberOfSections{ 20 };
+	double meanDgd{ 10e-12 };				// s
+	int fftSize{ 0 };						// power of 2, 0 to choose the smallest one of at least 8 times guard and 1024
+	int guardLength{ 0 };					// samples, 0 to derive the guard from the impulse response
+	int numberOfThreads{ 0 };				// threads of the workerPool() a large FFT is split across, 0 for all of them
+
+	long long seed{ -1 };					// seed of the rotations, -1 for the run seed (see setRunSeed())
+	long long streamId{ -1 };				// stream of the rotations, -1 for a stream of its own (newDefaultStream())
+
+	/* Methods */
+
+	PmdEmulator(vector<Signal *> &InputSig, vector<Signal *> &OutputSig);
+
+	void initialize(void);
+	bool runBlock(void);
+
+	void setNumberOfSections(int n) { numberOfSections = n; };
+	int const getNumberOfSections(void) { return numberOfSections; };
+
+	void setMeanDgd(double dgd) { meanDgd = dgd; };
+	double const getMeanDgd(void) { return meanDgd; };
+
+	void setFftSize(int n) { fftSize = n; };
+	int const getFftSize(void) { return (frameSize > 0) ? frameSize : fftSize; };
+
+	void setGuardLength(int g) { guardLength = g; };
+
+	void setNumberOfThreads(int n) { numberOfThreads = n; };
+	int const getNumberOfThreads(void) { return numberOfThreads; };
+
+	void setSeed(long long s) { seed = s; };
+	long long const getSeed(void) { return seed; };
+
+	void setStreamId(long long id) { streamId = id; };
+	long long const getStreamId(void) { return streamId; };
+
+	int const getDelay(void) { return guard; };						// samples, valid after initialize()
+
+	t_jones jonesMatrix(double frequency) const;					// of the whole emulator, frequency relative to the central one, valid after initialize()
+	double differentialGroupDelay(double frequency) const;			// s, of the whole emulator, valid after initialize()
+};
+
+# endif
@@ -0,0 +1,65 @@
+# ifndef POLARIZATION_ELEMENT_H_
+# define POLARIZATION_ELEMENT_H_
+
+# include "netplus.h"
+
+t_jones jonesProduct(const t_jones &a, const t_jones &b);		// a b, b applied first
+
+/* Lumped polarization element of a BandpassSignalXY, the same Jones matrix for every sample:
+	J = 10^(-insertionLoss_dB/20) P(pdl_dB, pdlAngle) W(retardance, retarderAngle) R(rotationAngle),
+with R(a) = [cos a  -sin a; sin a  cos a] a rotation of the polarization, W a linear retarder with phase retardance between its axes,
+the fast one at retarderAngle from X, W = R(b) diag(exp(j d/2), exp(-j d/2)) R(-b), and P a polarization dependent loss of pdl_dB,
+the axis of least loss at pdlAngle, P = R(c) diag(1, 10^(-pdl_dB/20)) R(-c). The factors are multiplied once, at initialize(), so a
+chain of rotations, retarders and PDL costs a single pass over the samples (dspKernels().jonesMatrix); setJonesMatrix() replaces the
+product by any other matrix. */
+class PolarizationElement : public Block {
+
+	/* State Variables */
+
+	bool firstTime{ true };
+
+	t_jones matrix;
+
+	bool userMatrix{ false };
+
+public:
+
+	/* Input Parameters */
+
+	double rotationAngle{ 0 };				// rad
+	double retardance{ 0 };					// rad
+	double retarderAngle{ 0 };				// rad
+	double pdl_dB{ 0 };
+	double pdlAngle{ 0 };					// rad
+	double insertionLoss_dB{ 0 };
+
+	/* Methods */
+
+	PolarizationElement(vector<Signal *> &InputSig, vector<Signal *> &OutputSig) :Block(InputSig, OutputSig){};
+
+	void initialize(void);
+	bool runBlock(void);
+
+	void setRotationAngle(double a) { rotationAngle = a; };
+	double const getRotationAngle(void) { return rotationAngle; };
+
+	void setRetardance(double d) { retardance = d; };
+	double const getRetardance(void) { return retardance; };
+
+	void setRetarderAngle(double b) { retarderAngle = b; };
+	double const getRetarderAngle(void) { return retarderAngle; };
+
+	void setPdl_dB(double pdl) { pdl_dB = pdl; };
+	double const getPdl_dB(void) { return pdl_dB; };
+
+	void setPdlAngle(double c) { pdlAngle = c; };
+	double const getPdlAngle(void) { return pdlAngle; };
+
+	void setInsertionLoss_dB(double l) { insertionLoss_dB = l; };
+	double const getInsertionLoss_dB(void) { return insertionLoss_dB; };
+
+	void setJonesMatrix(t_jones j) { matrix = j; userMatrix = true; };
+	t_jones const getJonesMatrix(void) { return matrix; };			// valid after initialize(), or once set
+};
+
+# endif
@@ -0,0 +1,42 @@
+# ifndef POLARIZATION_MULTIPLEXER_H_
+# define POLARIZATION_MULTIPLEXER_H_
+
+# include "netplus.h"
+
+/* Combines two BandpassSignals, in either layout, into a BandpassSignalXY: the first input is the X polarization, the second one the Y
+polarization. The samples are written straight into the output buffer, as many as both inputs have ready on each run. */
+class PolarizationMultiplexer : public Block {
+
+	/* State Variables */
+
+	bool firstTime{ true };
+
+public:
+
+	/* Methods */
+
+	PolarizationMultiplexer(vector<Signal *> &InputSig, vector<Signal *> &OutputSig) :Block(InputSig, OutputSig){};
+
+	void initialize(void);
+	bool runBlock(void);
+};
+
+/* Splits a BandpassSignalXY into its X polarization, the first output, and its Y polarization, the second one, two BandpassSignals in
+either layout. */
+class PolarizationDemultiplexer : public Block {
+
+	/* State Variables */
+
+	bool firstTime{ true };
+
+public:
+
+	/* Methods */
+
+	PolarizationDemultiplexer(vector<Signal *> &InputSig, vector<Signal *> &OutputSig) :Block(InputSig, OutputSig){};
+
+	void initialize(void);
+	bool runBlock(void);
+};
+
+# endif
@@ -0,0 +1,126 @@
+# ifndef POLYPHASE_PULSE_SHAPER_H_
+# define POLYPHASE_PULSE_SHAPER_H_
+
+# include <vector>
+# include "netplus.h"
+# include "pulse_shaper.h"
+# include "fixed_point.h"
+# include "dsp_kernels.h"
+
+using namespace std;
+
+/* Polyphase interpolating pulse shaper. It replaces the DiscreteToContinuousTime + PulseShaper pair: it reads symbols at the symbol rate
+and writes numberOfSamplesPerSymbol shaped samples per symbol. The impulse response is split in numberOfSamplesPerSymbol branches, so each
+output sample costs impulseResponseLength / numberOfSamplesPerSymbol MACs and the inserted zeros are never processed.
+The dot products use the dispatched DSP kernels (dsp_kernels.h). With the scalar kernels (NETPLUS_ISA=scalar) the output is identical to
+the one of the DiscreteToContinuousTime + PulseShaper pair with the same parameters, the vector kernels only change the rounding.
+With a complex input signal the same real taps are applied to the I and Q components in a single pass.
+For 8, 16 or 32 samples per symbol with 8, 16 or 32 symbols of impulse response, all the branches of a symbol are computed at once by a
+kernel compiled for that shape (dsp_kernels.h); other shapes use the run-time dot product.
+With a fixed-point input signal the block is bit-accurate: the taps are quantized to tapsFixedPointFormat, the products are accumulated
+exactly with the integer kernels, and each sample is rounded once to outputFixedPointFormat. The output signal must then be fixed-point too.
+The symbols are then shaped a span at a time, read from and written to the signal buffers directly; for the shapes above the integer
+kernel computes all the branches of the span in 32 bits, when that is exact for the taps and the input format (fixedPolyphaseFirFits),
+and the other cases use the 64-bit fixedDotProduct.
+INPUT PARAMETERS:
+int numberOfSamplesPerSymbol{ 8 };
+PulseShaperFilter filterType{ RaisedCosine };
+int impulseResponseTimeLength{ 16 };
+double rollOffFactor{ 0.9 };
+FixedPointFormat tapsFixedPointFormat{ 1, 14 };
+FixedPointFormat outputFixedPointFormat{ 3, 12 };
+*/
+class PolyphasePulseShaper : public Block {
+
+	/* State Variables */
+
+	vector<t_real> symbolHistory;						// last numberOfTapsPerPhase symbols, stored twice to be read as a contiguous window
+	vector<t_complex> complexSymbolHistory;				// used instead of symbolHistory when the input signal is complex
+	vector<t_fixed> fixedSymbolHistory;					// fixed-point input, the last numberOfTapsPerPhase - 1 symbols followed by the span being shaped
+	int historyPosition{ 0 };							// position of the oldest symbol in symbolHistory
+	int phase{ 0 };										// next output branch, 0 <= phase < numberOfSamplesPerSymbol
+
+	PolyphaseFirKernel firKernel{ nullptr };			// kernel specialized for the filter shape, if there is one
+	ComplexPolyphaseFirKernel complexFirKernel{ nullptr };
+	vector<t_real> symbolOutputs;						// outputs of all the branches for the last symbol, with a specialized kernel
+	vector<t_complex> complexSymbolOutputs;
+
+	FixedPolyphaseFirKernel fixedFirKernel{ nullptr };	// specialized kernel of the fixed-point input, if there is one and it is exact
+	vector<t_fixed> fixedTapPairs;						// fixedPolyphaseTaps stored in pairs of taps, for fixedFirKernel
+	vector<t_integer> fixedAccumulators;				// exact sums of the span, before the rounding to outputFixedPointFormat
+	vector<t_fixed> fixedOutputs;						// shaped samples of the span
+	int fixedOutputsPending{ 0 };						// samples at the end of fixedOutputs not yet written
+
+	template<typename T> bool shape(vector<T> &history, void(*kernel)(const T *, const t_real *, T *), vector<T> &outputs);
+	bool shapeFixedPoint(void);
+
+	bool saveImpulseResponse{ true };
+	string impulseResponseFilename{ "impulse_response.imp" };
+
+	/* Input Parameters */
+
+	int numberOfSamplesPerSymbol{ 8 };
+
+	PulseShaperFilter filterType{ RaisedCosine };
+
+	int impulseResponseTimeLength{ 16 };				// in units of symbol period
+
+	double rollOffFactor{ 0.9 };						// Roll-off factor (roll) for the raised-cosine filter
+
+	bool seeBeginningOfImpulseResponse{ false };
+
+	bool specializedKernels{ true };					// use the compile-time shaped kernels when available
+
+	FixedPointFormat tapsFixedPointFormat{ 1, 14 };
+	FixedPointFormat outputFixedPointFormat{ 3, 12 };
+
+public:
+
+	/* State Variables */
+
+	shared_ptr<const PulseShaperTaps> impulseResponse;	// shared with all the pulse shapers with the same parameters
+	int impulseResponseLength;							// filter order + 1, in output samples
+
+	int numberOfTapsPerPhase;							// ceil(impulseResponseLength / numberOfSamplesPerSymbol)
+	vector<t_real> polyphaseTaps;						// numberOfSamplesPerSymbol branches, each with numberOfTapsPerPhase taps ordered from the oldest to the newest symbol
+	vector<t_real> tapMajorTaps;						// polyphaseTaps stored tap by tap, tap m of branch p at m * numberOfSamplesPerSymbol + p
+	vector<t_fixed> fixedPolyphaseTaps;					// polyphaseTaps in tapsFixedPointFormat, only with a fixed-point input signal
+
+	/* Methods */
+
+	PolyphasePulseShaper(vector<Signal *> &InputSig, vector<Signal *> &OutputSig) :Block(InputSig, OutputSig){};
+
+	void initialize(void);
+
+	bool runBlock(void);
+
+	void setNumberOfSamplesPerSymbol(int nSamplesPerSymbol){ numberOfSamplesPerSymbol = nSamplesPerSymbol; };
+	int const getNumberOfSamplesPerSymbol(void){ return numberOfSamplesPerSymbol; };
+
+	void setImpulseResponseTimeLength(int impResponseTimeLength){ impulseResponseTimeLength = impResponseTimeLength; };
+	int const getImpulseResponseTimeLength(void) { return impulseResponseTimeLength; };
+
+	void setFilterType(PulseShaperFilter fType){ filterType = fType; };
+	PulseShaperFilter const getFilterType(void){ return filterType; };
+
+	void setRollOffFactor(double rOffFactor){ rollOffFactor = rOffFactor; };
+	double const getRollOffFactor(){ return rollOffFactor; };
+
+	void setSaveImpulseResponse(bool sImpulseResponse) { saveImpulseResponse = sImpulseResponse; };
+	bool getSaveImpulseResponse(void){ return saveImpulseResponse; };
+
+	void setSeeBeginningOfImpulseResponse(bool sBeginning){ seeBeginningOfImpulseResponse = sBeginning; };
+	bool const getSeeBeginningOfImpulseResponse(){ return seeBeginningOfImpulseResponse; };
+
+	void setSpecializedKernels(bool sKernels){ specializedKernels = sKernels; };
+	bool const getSpecializedKernels(void){ return specializedKernels; };
+
+	void setTapsFixedPointFormat(FixedPointFormat format){ tapsFixedPointFormat = format; };
+	FixedPointFormat const getTapsFixedPointFormat(void){ return tapsFixedPointFormat; };
+
+	void setOutputFixedPointFormat(FixedPointFormat format){ outputFixedPointFormat = format; };
+	FixedPointFormat const getOutputFixedPointFormat(void){ return outputFixedPointFormat; };
+
+};
+
+# endif
@@ -2,12 +2,40 @@
 # define PULSE_SHAPER_H_
 
 # include <vector>
+# include <memory>		// shared_ptr
 # include "netplus.h"
 
 using namespace std;
 
 enum PulseShaperFilter { RaisedCosine };
 
+const int TAPS_ALIGNMENT = 64;	// Alignment of the shared impulse responses, in bytes
+
+void raisedCosine(vector<t_real> &impulseResponse, int impulseResponseLength, double rollOffFactor, double samplingPeriod, double symbolPeriod);
+
+/* Immutable pulse shaper impulse response, aligned to TAPS_ALIGNMENT bytes. It is computed once per process for each
+(filter type, roll-off factor, samples per symbol, impulse response time length) and shared by all the filters that use it. */
+class PulseShaperTaps {
+
+	vector<t_real> storage;
+	int offset{ 0 };
+
+public:
+
+	int impulseResponseLength;
+
+	PulseShaperTaps(PulseShaperFilter filterType, double rollOffFactor, int impulseResponseTimeLength, double samplingPeriod, double symbolPeriod);
+
+	const t_real *data(void) const { return storage.data() + offset; };
+	int size(void) const { return impulseResponseLength; };
+	t_real operator[](int i) const { return storage[offset + i]; };
+
+	void save(string fileName, double samplingPeriod) const;		// Writes the impulse response file of a filter with this sampling period, once per process
+};
+
+// Thread-safe access to the process-wide impulse response cache.
+shared_ptr<const PulseShaperTaps> getPulseShaperTaps(PulseShaperFilter filterType, double rollOffFactor, int impulseResponseTimeLength, double samplingPeriod, double symbolPeriod);
+
 /* Raised-cosine filter FIR implementation. */
 class PulseShaper : public FIR_Filter{
 
@@ -17,6 +45,9 @@ class PulseShaper : public FIR_Filter{
 	int impulseResponseTimeLength{ 16 };				// in units of symbol period
 
 	double rollOffFactor{ 0.9 };						// Roll-off factor (roll) for the raised-cosine filter
+
+	/* State Variables */
+	shared_ptr<const PulseShaperTaps> taps;
 	
 
 public:
@@ -26,6 +57,8 @@ public:
 	PulseShaper(vector<Signal *> &InputSig, vector<Signal *> OutputSig) :FIR_Filter(InputSig, OutputSig){};
 
 	void initialize(void);
+
+	void writeImpulseResponse(void);		// Through the shared taps, once per distinct filter
 	
 	void setImpulseResponseTimeLength(int impResponseTimeLength){ impulseResponseTimeLength = impResponseTimeLength; };
 	int const getImpulseResponseTimeLength(void) { return impulseResponseTimeLength; };
@@ -0,0 +1,80 @@
+# ifndef RANDOM_GENERATOR_H_
+# define RANDOM_GENERATOR_H_
+
+# include <cstdint>		// uint64_t
+# include "netplus.h"
+
+using namespace std;
+
+/* xoshiro256** generator (D. Blackman and S. Vigna): 64 random bits per call in a few cycles, with period 2^256-1.
+The 256-bit state is expanded from a 64-bit seed with SplitMix64, so that any seed, 0 included, gives a well mixed state.
+A given seed always produces the same sequence, on any platform. */
+class Xoshiro256 {
+
+	uint64_t s[4];
+
+	static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+public:
+
+	Xoshiro256(uint64_t seed = 0) { setSeed(seed); };
+
+	void setSeed(uint64_t seed) {
+		for (int i = 0; i < 4; i++) {
+			uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+			s[i] = z ^ (z >> 31);
+		}
+	};
+
+	uint64_t next(void) {
+		uint64_t value = rotl(s[1] * 5, 7) * 9;
+		uint64_t t = s[1] << 17;
+		s[2] ^= s[0];
+		s[3] ^= s[1];
+		s[1] ^= s[2];
+		s[0] ^= s[3];
+		s[2] ^= t;
+		s[3] = rotl(s[3], 45);
+		return value;
+	};
+
+};
+
+/* Counter-based generator for reproducible parallel streams. The value of a sample is a function of (seed, stream, index) only: the
+Philox4x32-10 output of the counter (index / 2, stream) under the key seed, from the dspKernels() table. So a given sample always gets
+the same value, whatever the order, the thread or the process that computes it, and a run split in segments reproduces the whole run.
+Each stochastic block draws from its own stream, usually its block id, with the seed of the run (see setRunSeed()).
+The bulk methods return the samples index first, ..., first + n - 1; a stream must not be read with two different methods at the same indices.
+The Gaussian samples are computed by dspKernels().boxMuller, their last bits may differ between instruction set levels (see NETPLUS_ISA).
+The methods keep no state, so one generator can be shared by several threads. */
+class CounterRng {
+
+	uint64_t seed;
+	uint64_t stream;
+
+public:
+
+	CounterRng(uint64_t s = 0, uint64_t st = 0) : seed(s), stream(st) {};
+
+	void setSeed(uint64_t s) { seed = s; };
+	uint64_t getSeed(void) const { return seed; };
+
+	void setStream(uint64_t st) { stream = st; };
+	uint64_t getStream(void) const { return stream; };
+
+	void words(uint64_t first, uint64_t *out, int n) const;							// uniform 64-bit words
+	void uniform(uint64_t first, t_real *out, int n) const;						// uniform in [0, 1)
+	void gaussian(uint64_t first, t_real *out, int n) const;						// zero mean, unit variance (Box-Muller on the pairs 2k, 2k+1)
+	void bernoulli(uint64_t first, double probabilityOfZero, t_binary *out, int n) const;	// 0 with probability probabilityOfZero, 1 otherwise
+};
+
+void setRunSeed(uint64_t seed);		// seed of the counter-based streams of the blocks that do not set their own, 0 by default
+uint64_t getRunSeed(void);
+
+// Stream of a stochastic block without a streamId of its own: 2^32, 2^32 + 1, ..., in the order the blocks are constructed, out of the way
+// of the stream ids set by hand.
+uint64_t newDefaultStream(void);
+
+# endif
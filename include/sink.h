@@ -1,6 +1,7 @@
 # ifndef SINK_H_
 # define SINK_H_
 
+# include <chrono>
 # include "netplus.h"
 
 class Sink : public Block {
@@ -8,6 +9,8 @@ class Sink : public Block {
 	/* State Variables */
 
 	bool displayNumberOfSamples{ false };
+	double displayInterval{ 1.0 };								// seconds between two displays of numberOfSamples
+	chrono::steady_clock::time_point lastDisplay{};
 
 public:
 
@@ -24,6 +27,7 @@ public:
 	void setNumberOfSamples(long int nOfSamples){ numberOfSamples = nOfSamples; };
 
 	void setDisplayNumberOfSamples(bool opt) { displayNumberOfSamples = opt; };
+	void setDisplayInterval(double seconds) { displayInterval = seconds; };
 
 };
 
@@ -0,0 +1,53 @@
+# ifndef WORKER_POOL_H_
+# define WORKER_POOL_H_
+
+# include <atomic>
+# include <condition_variable>
+# include <cstdint>		// uint64_t
+# include <functional>
+# include <mutex>
+# include <thread>
+# include <vector>
+
+using namespace std;
+
+/* Persistent threads that run the indices of a task in parallel. run(count, task) calls task(0), ..., task(count - 1), each index once,
+on the workers and on the calling thread, and returns when all of them are done. The workers sleep between tasks, so a pool costs
+nothing while the simulation runs other blocks. A run() called from inside a task runs serially on its thread, so parallel code can be
+nested without deadlock; run() calls from different threads are serialized. */
+class WorkerPool {
+
+	vector<thread> workers;
+
+	mutex runMutex;							// one task at a time
+	mutex poolMutex;						// guards the fields below
+	condition_variable wake;
+	condition_variable done;
+	const function<void(int)> *task{ nullptr };
+	int taskCount{ 0 };
+	atomic<int> nextIndex{ 0 };
+	int busyWorkers{ 0 };
+	uint64_t generation{ 0 };
+	bool stopping{ false };
+
+	void workerLoop(void);
+	void work(void);						// runs indices of the current task until none is left
+
+public:
+
+	WorkerPool(int numberOfWorkers);
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool &) = delete;
+	WorkerPool &operator=(const WorkerPool &) = delete;
+
+	int size(void) const { return (int) workers.size() + 1; };		// threads of a run(), the caller included
+
+	void run(int count, const function<void(int)> &task);
+};
+
+// Process-wide pool, created at the first call with one thread per hardware thread, or with the number of threads given by the
+// environment variable NETPLUS_THREADS.
+WorkerPool &workerPool(void);
+
+# endif
@@ -11,6 +11,7 @@
 
 # include "netplus.h"
 # include "binary_source.h"
+# include "dsp_kernels.h"
 
 using namespace std;
 
@@ -36,193 +37,366 @@ void BinarySource::initialize(void){
 		outputSignals[i]->samplesPerSymbol = 1;
 		outputSignals[i]->setFirstValueToBeSaved(1);
 	}
+
+	if (bitOffset > 0 && bitStream.size() > 0) {
+		if (mode == DeterministicCyclic) posBitStream = (int)(bitOffset % (long long) bitStream.size());
+		if (mode == DeterministicAppendZeros) posBitStream = (int) min(bitOffset, (long long) bitStream.size());
+	}
+
+	if (mode == DeterministicCyclic || mode == DeterministicAppendZeros) initializePattern();
+
+	if (mode == BitFile) initializeBitFile();
 }
 
-bool BinarySource::runBlock(void) {
+// Initial bits of the PRBS register (bit 0 is the most recent one), the pattern of the original generator extended with alternating bits.
+static uint64_t prbsSeedBit(int i) {
+	if (i < 6) return (0x0A >> i) & 1;
+	return (i != 32 && i % 2 == 0) ? 1 : 0;
+}
 
-	int space = outputSignals[0]->space();
+static uint64_t parity(uint64_t x) {
+	x ^= x >> 32;
+	x ^= x >> 16;
+	x ^= x >> 8;
+	x ^= x >> 4;
+	x ^= x >> 2;
+	x ^= x >> 1;
+	return x & 1;
+}
 
-	int process;
-	if (numberOfBits >= 0) {
-		process = std::min((long int) space, numberOfBits);
+static uint64_t prbsStep(uint64_t state, uint64_t feedback, int len) {
+	return (state >> 1) | (parity(state & feedback) << (len - 1));
+}
+
+// a * b mod p(x), polynomials of degree lower than len, p(x) = x^len + pLow(x)
+static uint64_t prbsPolynomialMultiply(uint64_t a, uint64_t b, uint64_t pLow, int len) {
+	uint64_t value{ 0 };
+	for (int i = len - 1; i >= 0; i--) {
+		uint64_t carry = (value >> (len - 1)) & 1;
+		value = (len == 64) ? value << 1 : (value << 1) & ((1ULL << len) - 1);
+		if (carry) value ^= pLow;
+		if ((b >> i) & 1) value ^= a;
 	}
-	else {
-		process = space;
+	return value;
+}
+
+/* State n bits after the given one. Every state sequence satisfies the recurrence of the generator, whose characteristic polynomial is
+p(x) = x^len + feedback(x), so with x^n mod p(x) = sum c[i] x^i the state n bits ahead is the XOR of the states i bits ahead with c[i] = 1.
+x^n mod p(x) is computed by repeated squaring, in O(len^2 log n). */
+static uint64_t prbsJump(uint64_t state, unsigned long long n, uint64_t feedback, int len) {
+
+	uint64_t power{ 1 };
+	uint64_t x = (len == 1) ? feedback : 2;								// x mod p(x)
+	for (; n > 0; n >>= 1) {
+		if (n & 1) power = prbsPolynomialMultiply(power, x, feedback, len);
+		x = prbsPolynomialMultiply(x, x, feedback, len);
 	}
 
-	if (process <= 0) return false;
+	uint64_t jumped{ 0 };
+	for (int i = 0; i < len; i++) {
+		if ((power >> i) & 1) jumped ^= state;
+		state = prbsStep(state, feedback, len);
+	}
+	return jumped;
+}
 
-	if (mode == PseudoRandom){
+void BinarySource::initializePrbs(void) {
 
-		if (acumul.size() == 0) {
+	if (patternLength < 1 || patternLength > MAX_PRBS_PATTERN_LENGTH) {
+		cerr << "BinarySource: patternLength " << patternLength << " is not between 1 and " << MAX_PRBS_PATTERN_LENGTH << endl;
+		patternLength = max(1, min(patternLength, MAX_PRBS_PATTERN_LENGTH));
+	}
+	int len = patternLength;
 
-			acumul.resize(33);
+	// In prbsState the bit generated delay bits before is bit len - delay.
+	uint64_t feedback{ 0 };
+	for (int delay = 1; delay <= len; delay++) {
+		if (prbsFeedbackMask[len] & prbsTap(delay)) feedback |= 1ULL << (len - delay);
+	}
 
-			for (int i = 0; i < 32; i += 2) {
-				acumul[i] = 1;
-				acumul[i + 1] = 0;
+	// The generator is linear, so the next 64 bits are the XOR of the bits due to each state bit alone.
+	vector<uint64_t> response(len);
+	for (int i = 0; i < len; i++) {
+		uint64_t state = 1ULL << i;
+		uint64_t word{ 0 };
+		for (int k = 0; k < 64; k++) {
+			state = prbsStep(state, feedback, len);
+			word |= (state >> (len - 1)) << k;
+		}
+		response[i] = word;
+	}
+
+	int numberOfBytes = (len + 7) / 8;
+	prbsLeapTable.assign(256 * numberOfBytes, 0);
+	for (int j = 0; j < numberOfBytes; j++) {
+		for (int value = 0; value < 256; value++) {
+			for (int b = 0; b < 8 && 8 * j + b < len; b++) {
+				if ((value >> b) & 1) prbsLeapTable[256 * j + value] ^= response[8 * j + b];
 			}
-			acumul[5] = 0;
-			acumul[4] = 0;
-			acumul[3] = 1;
-			acumul[2] = 0;
-			acumul[1] = 1;
-			acumul[0] = 0;
 		}
+	}
+
+	// The first bits are the register, the oldest one first: the len + 1 bits of the original generator, that are followed by the
+	// PRBS of the last len ones, or just the state for the length 64.
+	int numberOfSeedBits = min(len + 1, 64);
+	bitWord = 0;
+	for (int k = 0; k < numberOfSeedBits; k++) bitWord |= prbsSeedBit(numberOfSeedBits - 1 - k) << k;
+	bitWordLeft = numberOfSeedBits;
+	prbsState = bitWord >> (numberOfSeedBits - len);
 
-		int len = patternLength;
-
-		vector<int>& ac = acumul;
-
-		for (int k = 0; k < process; k++) {
-			t_binary aux = (t_binary)ac[len];
-			outputSignals[0]->bufferPut((t_binary) aux);
-			numberOfBits--;
-
-			for (int i = len; i > 0; --i) ac[i] = ac[i - 1];
-
-			switch (len) {
-			case 1:
-				ac[0] = ac[1];
-				break;
-			case 2:
-				ac[0] = (ac[2] + ac[1]) % 2;
-				break;
-			case 3:
-				ac[0] = (ac[3] + ac[1]) % 2;
-				break;
-			case 4:
-				ac[0] = (ac[4] + ac[1]) % 2;
-				break;
-			case 5:
-				ac[0] = (ac[5] + ac[2]) % 2;
-				break;
-			case 6:
-				ac[0] = (ac[6] + ac[1]) % 2;
-				break;
-			case 7:
-				ac[0] = (ac[7] + ac[1]) % 2;
-				break;
-			case 8:
-				ac[0] = (ac[8] + ac[4] + ac[3] + ac[2]) % 2;
-				break;
-			case 9:
-				ac[0] = (ac[9] + ac[4]) % 2;
-				break;
-			case 10:
-				ac[0] = (ac[10] + ac[3]) % 2;
-				break;
-			case 11:
-				ac[0] = (ac[11] + ac[2]) % 2;
-				break;
-			case 12:
-				ac[0] = (ac[12] + ac[6] + ac[4] + ac[1]) % 2;
-				break;
-			case 13:
-				ac[0] = (ac[13] + ac[4] + ac[3] + ac[1]) % 2;
-				break;
-			case 14:
-				ac[0] = (ac[14] + ac[5] + ac[3] + ac[1]) % 2;
-				break;
-			case 15:
-				ac[0] = (ac[15] + ac[1]) % 2;
-				break;
-			case 16:
-				ac[0] = (ac[16] + ac[5] + ac[3] + ac[2]) % 2;
-				break;
-			case 17:
-				ac[0] = (ac[17] + ac[3]) % 2;
-				break;
-			case 18:
-				ac[0] = (ac[18] + ac[5] + ac[2] + ac[1]) % 2;
-				break;
-			case 19:
-				ac[0] = (ac[19] + ac[5] + ac[2] + ac[1]) % 2;
-				break;
-			case 20:
-				ac[0] = (ac[20] + ac[3]) % 2;
-				break;
-			case 21:
-				ac[0] = (ac[21] + ac[2]) % 2;
-				break;
-			case 22:
-				ac[0] = (ac[22] + ac[1]) % 2;
-				break;
-			case 23:
-				ac[0] = (ac[23] + ac[5]) % 2;
-				break;
-			case 24:
-				ac[0] = (ac[24] + ac[4] + ac[3] + ac[1]) % 2;
-				break;
-			case 25:
-				ac[0] = (ac[25] + ac[3]) % 2;
-				break;
-			case 26:
-				ac[0] = (ac[26] + ac[6] + ac[2] + ac[1]) % 2;
-				break;
-			case 27:
-				ac[0] = (ac[27] + ac[5] + ac[2] + ac[1]) % 2;
-				break;
-			case 28:
-				ac[0] = (ac[28] + ac[3]) % 2;
-				break;
-			case 29:
-				ac[0] = (ac[29] + ac[2]) % 2;
-				break;
-			case 30:
-				ac[0] = (ac[30] + ac[6] + ac[4] + ac[2]) % 2;
-				break;
-			case 31:
-				ac[0] = (ac[31] + ac[3]) % 2;
-				break;
-			case 32:
-				ac[0] = (ac[32] + ac[7] + ac[5] + ac[3] + ac[2] + ac[1]) % 2;
-				break;
+	// The state holds the bits numberOfSeedBits - len (0 or 1) onwards, after the jump they are the next bits to put.
+	if (bitOffset > 0) {
+		prbsState = prbsJump(prbsState, (unsigned long long)(bitOffset - (numberOfSeedBits - len)), feedback, len);
+		bitWord = prbsState;
+		bitWordLeft = len;
+	}
+}
+
+void BinarySource::initializeRandom(void) {
+
+	if (streamId >= 0) {
+		counterGenerator.setSeed((seed == -1) ? getRunSeed() : (uint64_t) seed);
+		counterGenerator.setStream((uint64_t) streamId);
+
+		// Equiprobable bit b is bit b % 64 of word b / 64, otherwise it is drawn from sample b.
+		if (probabilityOfZero == 0.5) {
+			counterIndex = (uint64_t)(bitOffset / 64);
+			int skip = (int)(bitOffset % 64);
+			if (skip > 0) {
+				nextWords(&bitWord, 1);
+				bitWord >>= skip;
+				bitWordLeft = 64 - skip;
 			}
 		}
+		else {
+			counterIndex = (uint64_t) bitOffset;
+		}
+	}
+	else if (seed == -1) {
+		random_device rd;
+		generator.setSeed(((uint64_t) rd() << 32) | rd());
+	}
+	else {
+		generator.setSeed((uint64_t) seed);
 	}
 
-	if (mode == Random){
+	randomInitialized = true;
+}
+
+void BinarySource::nextWords(uint64_t *out, int n) {
+	if (mode == PseudoRandom) {
+		for (int w = 0; w < n; w++) out[w] = nextPrbsWord();
+	}
+	else if (streamId >= 0) {
+		counterGenerator.words(counterIndex, out, n);
+		counterIndex = counterIndex + n;
+	}
+	else {
+		for (int w = 0; w < n; w++) out[w] = generator.next();
+	}
+}
+
+uint64_t BinarySource::nextPrbsWord(void) {
+	uint64_t word{ 0 };
+	int numberOfBytes = (int) prbsLeapTable.size() / 256;
+	for (int j = 0; j < numberOfBytes; j++) word ^= prbsLeapTable[256 * j + ((prbsState >> (8 * j)) & 0xFF)];
+	prbsState = (patternLength == 64) ? word : word >> (64 - patternLength);
+	return word;
+}
+
+void BinarySource::putBits(int n) {
+
+	Signal *out = outputSignals[0];
+
+	for (; n > 0 && bitWordLeft > 0; n--, bitWordLeft--) {
+		out->bufferPut((t_binary)(bitWord & 1));
+		bitWord >>= 1;
+	}
+
+	// Whole words are unpacked straight into the buffer, the bits of a last partial word are kept for the next call.
+	while (n > 0) {
+		int numberOfWords = min(n, out->contiguousSpace()) / 64;
+		if (numberOfWords > 0) {
+			words.resize(numberOfWords);
+			nextWords(words.data(), numberOfWords);
+			dspKernels().unpackBits(words.data(), static_cast<t_binary *>(out->buffer) + out->inPosition, 64 * numberOfWords);
+			out->commitPut(64 * numberOfWords);
+			n = n - 64 * numberOfWords;
+		}
+		else {
+			nextWords(&bitWord, 1);
+			for (bitWordLeft = 64; n > 0 && bitWordLeft > 0; n--, bitWordLeft--) {
+				out->bufferPut((t_binary)(bitWord & 1));
+				bitWord >>= 1;
+			}
+		}
+	}
+}
 
-		std::random_device rd;
-		std::mt19937 gen(rd());
-		std::uniform_int_distribution<> dis(0, 1);
+void BinarySource::putRandomBits(int n) {
 
-		t_binary value;
-		for (int k = 0; k < process; k++) {
-			value = dis(gen);
-			outputSignals[0]->bufferPut((t_binary) value);
-			numberOfBits--;
+	Signal *out = outputSignals[0];
+
+	// P(0) = threshold / 2^64, a probabilityOfZero of 1 cannot be expressed as a threshold.
+	uint64_t threshold{ 0 };
+	if (probabilityOfZero > 0.0 && probabilityOfZero < 1.0) threshold = (uint64_t) ldexp(probabilityOfZero, 64);
+
+	while (n > 0) {
+		int run = min(n, out->contiguousSpace());
+		t_binary *bits = static_cast<t_binary *>(out->buffer) + out->inPosition;
+		if (streamId >= 0) {
+			counterGenerator.bernoulli(counterIndex, probabilityOfZero, bits, run);
+			counterIndex = counterIndex + run;
+		}
+		else if (probabilityOfZero >= 1.0) {
+			fill(bits, bits + run, 0);
+		}
+		else {
+			words.resize(run);
+			for (int k = 0; k < run; k++) words[k] = generator.next();
+			dspKernels().thresholdBits(words.data(), threshold, bits, run);
 		}
+		out->commitPut(run);
+		n = n - run;
 	}
+}
+
+/* The pattern is converted to bits once. In the DeterministicCyclic mode it is repeated at least up to patternSize - 1 + bufferLength bits,
+so that the bits of any contiguous run of the output buffer, from any position of the pattern, are a single copy from the tile. */
+void BinarySource::initializePattern(void) {
 
-	if (mode == DeterministicCyclic){
-		std::vector<char> values(bitStream.begin(), bitStream.end());
-		int valuesSize = values.size();
-		for (int k = 0; k < process; k++) {
-			t_binary aux = (t_binary)(values[posBitStream++] - '0');
-			outputSignals[0]->bufferPut(aux);
-			numberOfBits--;
-			posBitStream = posBitStream % valuesSize;
+	patternSize = (int) bitStream.size();
+
+	int tileSize = patternSize;
+	if (mode == DeterministicCyclic && patternSize > 0) {
+		int bufferLength = outputSignals[0]->getBufferLength();
+		tileSize = patternSize * ((bufferLength + patternSize - 2) / patternSize + 1);
+	}
+
+	patternTile.resize(tileSize);
+	for (int k = 0; k < tileSize; k++) patternTile[k] = (t_binary)(bitStream[k % patternSize] - '0');
+
+	patternInitialized = true;
+}
+
+void BinarySource::putPatternBits(int n) {
+
+	Signal *out = outputSignals[0];
+
+	// An empty pattern gives zeros in both modes; after the pattern the DeterministicAppendZeros stream is zeros.
+	while (n > 0) {
+		int run = min(n, out->contiguousSpace());
+		t_binary *bits = static_cast<t_binary *>(out->buffer) + out->inPosition;
+		if (mode == DeterministicCyclic && patternSize > 0) {
+			run = min(run, (int) patternTile.size() - posBitStream);
+			copy(patternTile.begin() + posBitStream, patternTile.begin() + posBitStream + run, bits);
+			posBitStream = (posBitStream + run) % patternSize;
+		}
+		else {
+			int copied = max(0, min(run, patternSize - posBitStream));
+			copy(patternTile.begin() + posBitStream, patternTile.begin() + posBitStream + copied, bits);
+			fill(bits + copied, bits + run, 0);
+			posBitStream = posBitStream + copied;
 		}
+		out->commitPut(run);
+		n = n - run;
+	}
+}
 
+void BinarySource::initializeBitFile(void) {
+
+	bitFileEnded = !bitFile.open(bitFileName, bitFileFormat);
+	if (bitFileEnded) {
+		cerr << "BinarySource: the bit file " << bitFileName << " cannot be opened" << endl;
+		return;
 	}
 
-	if (mode == DeterministicAppendZeros){
-		std::vector<char> values(bitStream.begin(), bitStream.end());
-		int valuesSize = values.size();
-		t_binary aux;
-		for (int k = 0; k < process; k++) {
-			if (posBitStream == valuesSize) {
-				aux = 0;
+	// With bitFileLoop an offset beyond the end of the file wraps around, the length of the file being the number of bits skipped.
+	long long skipped = bitFile.skip(bitOffset);
+	if (skipped < bitOffset && bitFileLoop && skipped > 0) {
+		bitFile.rewind();
+		bitFile.skip(bitOffset % skipped);
+	}
+}
+
+int BinarySource::putFileBits(int n) {
+
+	Signal *out = outputSignals[0];
+
+	// The bits are read straight into the buffer; a file that loops is rewound at its end, unless it has no bits at all.
+	int put{ 0 };
+	bool rewound{ false };
+	while (put < n && !bitFileEnded) {
+		int run = min(n - put, out->contiguousSpace());
+		int count = bitFile.read(static_cast<t_binary *>(out->buffer) + out->inPosition, run);
+		out->commitPut(count);
+		put = put + count;
+		if (count > 0) rewound = false;
+		if (count < run) {
+			if (bitFileLoop && !rewound) {
+				bitFile.rewind();
+				rewound = true;
 			}
 			else {
-				aux = (t_binary)(values[posBitStream++] - '0');
+				bitFileEnded = true;
 			}
-			outputSignals[0]->bufferPut(aux);
-			numberOfBits--;
 		}
+	}
+
+	return put;
+}
+
+bool BinarySource::runBlock(void) {
+
+	int space = outputSignals[0]->space();
+
+	int process;
+	if (numberOfBits >= 0) {
+		process = std::min((long int) space, numberOfBits);
+	}
+	else {
+		process = space;
+	}
+
+	if (process <= 0) return false;
+
+	if (mode == PseudoRandom){
+
+		if (prbsLeapTable.size() == 0) initializePrbs();
+
+		putBits(process);
+		numberOfBits = numberOfBits - process;
+	}
+
+	if (mode == Random){
+
+		if (!randomInitialized) initializeRandom();
+
+		// Equiprobable bits are the bits of the generator words, otherwise each bit compares one word with a threshold.
+		if (probabilityOfZero == 0.5) {
+			putBits(process);
+		}
+		else {
+			putRandomBits(process);
+		}
+		numberOfBits = numberOfBits - process;
+	}
+
+	if (mode == DeterministicCyclic || mode == DeterministicAppendZeros){
+
+		if (!patternInitialized) initializePattern();
+
+		putPatternBits(process);
+		numberOfBits = numberOfBits - process;
+	}
+
+	if (mode == BitFile){
+
+		if (!bitFile.isOpen() && !bitFileEnded) initializeBitFile();
 
+		process = putFileBits(process);
+		if (process == 0) return false;
+		numberOfBits = numberOfBits - process;
 	}
 
 	return true;
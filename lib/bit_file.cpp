@@ -0,0 +1,186 @@
+# include <algorithm>
+
+# if defined(_WIN32)
+# define WIN32_LEAN_AND_MEAN
+# define NOMINMAX
+# include <windows.h>
+# else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+# endif
+
+# include "netplus.h"
+# include "bit_file.h"
+
+using namespace std;
+
+bool BitFileReader::open(const string &fileName, BitFileFormat fileFormat) {
+
+	close();
+
+# if defined(_WIN32)
+	HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE) return false;
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size)) {
+		CloseHandle(file);
+		return false;
+	}
+	fileSize = size.QuadPart;
+	if (fileSize > 0) {
+		HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping == NULL) {
+			CloseHandle(file);
+			return false;
+		}
+		mappingHandle = (intptr_t) mapping;
+	}
+	fileHandle = (intptr_t) file;
+# else
+	int file = ::open(fileName.c_str(), O_RDONLY);
+	if (file < 0) return false;
+	struct stat status;
+	if (fstat(file, &status) != 0) {
+		::close(file);
+		return false;
+	}
+	fileSize = (long long) status.st_size;
+	fileHandle = file;
+# endif
+
+	format = fileFormat;
+	rewind();
+	return true;
+}
+
+void BitFileReader::close(void) {
+
+	if (!isOpen()) return;
+
+	unmapWindow();
+# if defined(_WIN32)
+	if (mappingHandle != 0) CloseHandle((HANDLE) mappingHandle);
+	CloseHandle((HANDLE) fileHandle);
+# else
+	::close((int) fileHandle);
+# endif
+	fileHandle = -1;
+	mappingHandle = 0;
+	fileSize = 0;
+}
+
+void BitFileReader::rewind(void) {
+	position = 0;
+	bitInByte = 0;
+}
+
+bool BitFileReader::mapWindow(long long offset) {
+
+	unmapWindow();
+
+	windowOffset = offset - offset % BIT_FILE_WINDOW;
+	windowLength = min(BIT_FILE_WINDOW, fileSize - windowOffset);
+
+# if defined(_WIN32)
+	void *view = MapViewOfFile((HANDLE) mappingHandle, FILE_MAP_READ, (DWORD)(windowOffset >> 32), (DWORD)(windowOffset & 0xFFFFFFFF), (SIZE_T) windowLength);
+	if (view == NULL) return false;
+	window = static_cast<const unsigned char *>(view);
+# else
+	void *view = mmap(nullptr, (size_t) windowLength, PROT_READ, MAP_PRIVATE, (int) fileHandle, (off_t) windowOffset);
+	if (view == MAP_FAILED) return false;
+	window = static_cast<const unsigned char *>(view);
+
+	// The window is read sequentially, and the next one is read ahead while this one is consumed.
+	madvise(view, (size_t) windowLength, MADV_SEQUENTIAL);
+	long long next = windowOffset + windowLength;
+	if (next < fileSize) posix_fadvise((int) fileHandle, (off_t) next, (off_t) min(BIT_FILE_WINDOW, fileSize - next), POSIX_FADV_WILLNEED);
+# endif
+
+	return true;
+}
+
+void BitFileReader::unmapWindow(void) {
+
+	if (window == nullptr) return;
+# if defined(_WIN32)
+	UnmapViewOfFile(window);
+# else
+	munmap(const_cast<unsigned char *>(window), (size_t) windowLength);
+# endif
+	window = nullptr;
+	windowLength = 0;
+}
+
+int BitFileReader::read(t_binary *bits, int n) {
+
+	int count = 0;
+
+	while (count < n && position < fileSize) {
+
+		if (window == nullptr || position < windowOffset || position >= windowOffset + windowLength)
+			if (!mapWindow(position)) break;
+
+		const unsigned char *bytes = window + (position - windowOffset);
+		long long available = windowOffset + windowLength - position;
+
+		if (format == PackedBitFile) {
+			// Whole bytes are unpacked eight bits at a time, the bits of a byte split between two reads one at a time.
+			while (count < n && available > 0) {
+				if (bitInByte == 0 && n - count >= 8) {
+					int wholeBytes = (int) min(available, (long long)((n - count) / 8));
+					t_binary *out = bits + count;
+					for (int k = 0; k < wholeBytes; k++)
+						for (int j = 0; j < 8; j++) out[8 * k + j] = (t_binary)((bytes[k] >> (7 - j)) & 1);
+					count = count + 8 * wholeBytes;
+					bytes = bytes + wholeBytes;
+					position = position + wholeBytes;
+					available = available - wholeBytes;
+				}
+				else {
+					bits[count++] = (t_binary)((*bytes >> (7 - bitInByte)) & 1);
+					if (++bitInByte == 8) {
+						bitInByte = 0;
+						bytes++;
+						position++;
+						available--;
+					}
+				}
+			}
+		}
+		else {
+			long long k = 0;
+			while (count < n && k < available) {
+				unsigned char c = bytes[k++];
+				if (c == '0' || c == '1') bits[count++] = (t_binary)(c - '0');
+			}
+			position = position + k;
+		}
+	}
+
+	return count;
+}
+
+long long BitFileReader::skip(long long n) {
+
+	if (n <= 0) return 0;
+
+	if (format == PackedBitFile) {
+		long long next = 8 * position + bitInByte;
+		long long skipped = min(n, 8 * fileSize - next);
+		next = next + skipped;
+		position = next / 8;
+		bitInByte = (int)(next % 8);
+		return skipped;
+	}
+
+	t_binary scratch[4096];
+	long long skipped{ 0 };
+	while (skipped < n) {
+		int count = read(scratch, (int) min(n - skipped, (long long) 4096));
+		if (count == 0) break;
+		skipped = skipped + count;
+	}
+	return skipped;
+}
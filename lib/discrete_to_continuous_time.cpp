@@ -21,7 +21,7 @@ bool DiscreteToContinuousTime::runBlock(void) {
 
 	if (index != 0) {
 		for (int i = index; (i < numberOfSamplesPerSymbol) & (space>0); i++) {
-			outputSignals[0]->bufferPut(0);
+			outputSignals[0]->bufferPut((t_real) 0.0);
 			alive = true;
 			space--;
 			index++;
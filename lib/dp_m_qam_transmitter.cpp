@@ -0,0 +1,42 @@
+# include <climits>		// LLONG_MAX
+
+# include "dp_m_qam_transmitter.h"
+
+
+void DpMQamTransmitter::initialize(void) {
+
+	// The Y tributary starts half a period after X, so that the two polarizations carry uncorrelated bits
+	unsigned long long halfPeriod{ 0 };
+	if (B1.getMode() == PseudoRandom) {
+		int len = min(max(B1.getPatternLength(), 1), MAX_PRBS_PATTERN_LENGTH);
+		halfPeriod = (~0ULL >> (64 - len)) / 2;
+	}
+	if (B1.getMode() == DeterministicCyclic) halfPeriod = B1.getBitStream().size() / 2;
+
+	if (yBitOffset >= 0) B2.setBitOffset(yBitOffset);
+	else {
+		unsigned long long offset = (unsigned long long) B1.getBitOffset() + halfPeriod;
+		B2.setBitOffset((offset > (unsigned long long) LLONG_MAX) ? LLONG_MAX : (long long) offset);
+	}
+
+	SuperBlock::initialize();
+}
+
+void DpMQamTransmitter::set(int opt) {
+
+	// Basic Configuration
+
+	if (opt==0) {
+		setMode(PseudoRandom);
+		setBitPeriod(1.0 / 50e9);
+		setPatternLength(15);
+		setNumberOfBits(10000);
+		setNumberOfSamplesPerSymbol(32);
+		setRollOffFactor(0.9);
+		setIqAmplitudes({ { 1, 1 }, { -1, 1 }, { -1, -1 }, { 1, -1 } });
+		setOutputOpticalPower_dBm(0);
+		setSaveInternalSignals(true);
+	}
+
+	return;
+}
@@ -0,0 +1,1618 @@
+# include <cstdlib>		// getenv, free
+# include <cstring>		// memcpy
+
+# include "netplus.h"
+# include "dsp_kernels.h"
+
+# if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+# define DSP_KERNELS_X86
+# include <immintrin.h>
+# if defined(_MSC_VER)
+# include <intrin.h>		// __cpuidex, _xgetbv
+# endif
+# endif
+
+// MSVC accepts the intrinsics of any level in any function, GCC and Clang need them enabled function by function. The generic kernels
+// wrapped for each level are therefore only compiled for that level by GCC and Clang, see dsp_kernels.h.
+# if defined(_MSC_VER)
+# define DSP_TARGET_AVX2
+# define DSP_TARGET_AVX512
+# define DSP_INLINE __forceinline
+# else
+# define DSP_TARGET_AVX2 __attribute__((target("avx2,fma")))
+# define DSP_TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+# define DSP_INLINE inline __attribute__((always_inline))
+# endif
+
+using namespace std;
+
+//########################################################################################################################################################
+//############################################################### SCALAR KERNELS ##########################################################################
+//########################################################################################################################################################
+
+static t_real dotProductScalar(const t_real *x, const t_real *h, int n) {
+	t_real value{ 0.0 };
+	for (int m = 0; m < n; m++) value += x[m] * h[m];
+	return value;
+}
+
+static t_complex complexDotProductScalar(const t_complex *x, const t_real *h, int n) {
+	const t_real *iq = reinterpret_cast<const t_real *>(x);
+	t_real re{ 0.0 };
+	t_real im{ 0.0 };
+	for (int m = 0; m < n; m++) {
+		re += iq[2 * m] * h[m];
+		im += iq[2 * m + 1] * h[m];
+	}
+	return t_complex(re, im);
+}
+
+static void complexScaleScalar(const t_complex *in, t_real scale, t_complex *out, int n) {
+	for (int m = 0; m < n; m++) out[m] = scale * in[m];
+}
+
+static void complexMultiplyScalar(const t_complex *a, const t_complex *b, t_complex *out, int n) {
+	for (int m = 0; m < n; m++) {
+		t_real re = a[m].real() * b[m].real() - a[m].imag() * b[m].imag();
+		t_real im = a[m].real() * b[m].imag() + a[m].imag() * b[m].real();
+		out[m] = t_complex(re, im);
+	}
+}
+
+static void interleaveScalar(const t_real *re, const t_real *im, t_complex *out, int n) {
+	for (int m = 0; m < n; m++) out[m] = t_complex(re[m], im[m]);
+}
+
+static void deinterleaveScalar(const t_complex *in, t_real *re, t_real *im, int n) {
+	for (int m = 0; m < n; m++) {
+		re[m] = in[m].real();
+		im[m] = in[m].imag();
+	}
+}
+
+static void unpackBitsScalar(const uint64_t *words, t_binary *bits, int n) {
+	for (int i = 0; i < n; i++) bits[i] = (t_binary)((words[i >> 6] >> (i & 63)) & 1);
+}
+
+// The split complex and the threshold kernels only use vertical operations, the compiler vectorizes them for each level (see the wrappers below).
+DSP_INLINE void realScale(const t_real *in, t_real scale, t_real *out, int n) {
+	for (int m = 0; m < n; m++) out[m] = scale * in[m];
+}
+
+DSP_INLINE void splitComplexMultiply(const t_real *aRe, const t_real *aIm, const t_real *bRe, const t_real *bIm, t_real *outRe, t_real *outIm, int n) {
+	for (int m = 0; m < n; m++) {
+		t_real re = aRe[m] * bRe[m] - aIm[m] * bIm[m];
+		t_real im = aRe[m] * bIm[m] + aIm[m] * bRe[m];
+		outRe[m] = re;
+		outIm[m] = im;
+	}
+}
+
+DSP_INLINE void thresholdBits(const uint64_t *values, uint64_t threshold, t_binary *bits, int n) {
+	for (int m = 0; m < n; m++) bits[m] = (values[m] >= threshold) ? 1 : 0;
+}
+
+/* Philox4x32-10 (J. Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC11), 16 blocks at a time in structure of arrays form
+so that the rounds are vectorized across the blocks. The counter of a block is (block, stream) and the key is the seed. */
+const uint32_t PHILOX_M0 = 0xD2511F53;
+const uint32_t PHILOX_M1 = 0xCD9E8D57;
+const uint32_t PHILOX_W0 = 0x9E3779B9;
+const uint32_t PHILOX_W1 = 0xBB67AE85;
+const int PHILOX_LANES = 16;
+
+DSP_INLINE void philox(uint64_t key, uint64_t stream, uint64_t firstBlock, uint64_t *out, int n) {
+	for (int k = 0; k < n; k += PHILOX_LANES) {
+		uint32_t c0[PHILOX_LANES], c1[PHILOX_LANES], c2[PHILOX_LANES], c3[PHILOX_LANES];
+		for (int j = 0; j < PHILOX_LANES; j++) {
+			uint64_t block = firstBlock + k + j;
+			c0[j] = (uint32_t) block;
+			c1[j] = (uint32_t)(block >> 32);
+			c2[j] = (uint32_t) stream;
+			c3[j] = (uint32_t)(stream >> 32);
+		}
+		uint32_t k0 = (uint32_t) key;
+		uint32_t k1 = (uint32_t)(key >> 32);
+		for (int round = 0; round < 10; round++) {
+			for (int j = 0; j < PHILOX_LANES; j++) {
+				uint64_t p0 = (uint64_t) PHILOX_M0 * c0[j];
+				uint64_t p1 = (uint64_t) PHILOX_M1 * c2[j];
+				uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1[j] ^ k0;
+				uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3[j] ^ k1;
+				c1[j] = (uint32_t) p1;
+				c3[j] = (uint32_t) p0;
+				c0[j] = n0;
+				c2[j] = n2;
+			}
+			k0 += PHILOX_W0;
+			k1 += PHILOX_W1;
+		}
+		for (int j = 0; j < PHILOX_LANES && k + j < n; j++) {
+			out[2 * (k + j)] = c0[j] | ((uint64_t) c1[j] << 32);
+			out[2 * (k + j) + 1] = c2[j] | ((uint64_t) c3[j] << 32);
+		}
+	}
+}
+
+DSP_INLINE double doubleOfBits(uint64_t bits) {
+	double value;
+	memcpy(&value, &bits, sizeof(double));
+	return value;
+}
+
+DSP_INLINE uint64_t bitsOfDouble(double value) {
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(double));
+	return bits;
+}
+
+/* The elementary functions below are computed in double precision for any t_real, with integer operations on the bits instead of
+branches, conversions and libm calls that would keep the loops that call them from being vectorized. */
+
+/* sin and cos of x: Cody-Waite reduction by the nearest multiple q of pi/2, with pi/2 split in three parts, and the minimax polynomials
+of Cephes on [-pi/4, pi/4]. q is rounded by adding 1.5 * 2^52, which leaves it in the low bits of the mantissa, so that the quadrant
+q mod 4 is read from the bits and applied with selects. */
+DSP_INLINE void sinCosOf(double x, double &s, double &c) {
+	const double roundingShift = 6755399441055744.0;
+	double shifted = x * 0.63661977236758134308 + roundingShift;
+	uint64_t quadrant = bitsOfDouble(shifted);
+	double q = shifted - roundingShift;
+	double r = x - q * 1.57079625129699707031;
+	r = r - q * 7.54978941586159635336e-8;
+	r = r - q * 5.39030285815811905290e-15;
+	double r2 = r * r;
+
+	double sinR = 1.58962301576546568060e-10;
+	sinR = sinR * r2 - 2.50507477628578072866e-8;
+	sinR = sinR * r2 + 2.75573136213857245213e-6;
+	sinR = sinR * r2 - 1.98412698295895385996e-4;
+	sinR = sinR * r2 + 8.33333333332211858878e-3;
+	sinR = sinR * r2 - 1.66666666666666307295e-1;
+	sinR = r + r * r2 * sinR;
+
+	double cosR = -1.13585365213876817300e-11;
+	cosR = cosR * r2 + 2.08757008419747316778e-9;
+	cosR = cosR * r2 - 2.75573141792967388112e-7;
+	cosR = cosR * r2 + 2.48015872888517045348e-5;
+	cosR = cosR * r2 - 1.38888888888730564116e-3;
+	cosR = cosR * r2 + 4.16666666666665929218e-2;
+	cosR = 1.0 - 0.5 * r2 + r2 * r2 * cosR;
+
+	// sin(x) = sin(r), cos(r), -sin(r), -cos(r) and cos(x) = cos(r), -sin(r), -cos(r), sin(r) for q mod 4 = 0, 1, 2, 3
+	quadrant = quadrant & 3;
+	double sinX = (quadrant & 1) ? cosR : sinR;
+	double cosX = (quadrant & 1) ? sinR : cosR;
+	s = (quadrant & 2) ? -sinX : sinX;
+	c = ((quadrant + 1) & 2) ? -cosX : cosX;
+}
+
+/* Natural logarithm of a positive normal x = 2^e * m, m in [sqrt(1/2), sqrt(2)): e * ln 2 + 2 atanh((m - 1) / (m + 1)), with the atanh
+series up to the power 21 of |(m - 1) / (m + 1)| < 0.172, whose next term is below 2^-62. */
+DSP_INLINE double logOf(double x) {
+	uint64_t bits = bitsOfDouble(x);
+	uint64_t mantissa = bits & 0x000FFFFFFFFFFFFFULL;
+	uint64_t low = (mantissa < 0x6A09E667F3BCDULL) ? 1 : 0;				// m in [1, sqrt(2)) taken as 2m, one power of 2 down
+	double e = doubleOfBits(((bits >> 52) - low) | 0x4330000000000000ULL) - (4503599627370496.0 + 1022);
+	double m = doubleOfBits(mantissa | ((0x3FEULL + low) << 52));
+
+	double s = (m - 1) / (m + 1);
+	double s2 = s * s;
+	double p = 1.0 / 21;
+	p = p * s2 + 1.0 / 19;
+	p = p * s2 + 1.0 / 17;
+	p = p * s2 + 1.0 / 15;
+	p = p * s2 + 1.0 / 13;
+	p = p * s2 + 1.0 / 11;
+	p = p * s2 + 1.0 / 9;
+	p = p * s2 + 1.0 / 7;
+	p = p * s2 + 1.0 / 5;
+	p = p * s2 + 1.0 / 3;
+	return e * 0.69314718055994530942 + 2 * s + 2 * s * s2 * p;
+}
+
+DSP_INLINE void sinCos(const t_real *x, t_real *s, t_real *c, int n) {
+	for (int m = 0; m < n; m++) {
+		double sinX, cosX;
+		sinCosOf(x[m], sinX, cosX);
+		s[m] = (t_real) sinX;
+		c[m] = (t_real) cosX;
+	}
+}
+
+DSP_INLINE void polar(const t_real *magnitude, const t_real *phase, t_real *re, t_real *im, int n) {
+	for (int m = 0; m < n; m++) {
+		double sinX, cosX;
+		sinCosOf(phase[m], sinX, cosX);
+		re[m] = magnitude[m] * (t_real) cosX;
+		im[m] = magnitude[m] * (t_real) sinX;
+	}
+}
+
+DSP_INLINE void iqMachZehnder(const t_real *vI, const t_real *vQ, t_real phaseScale, t_real phaseI, t_real phaseQ, t_real leakage, t_real amplitude, t_real *re, t_real *im, int n) {
+	for (int m = 0; m < n; m++) {
+		double sinI, cosI, sinQ, cosQ;
+		sinCosOf(phaseScale * vI[m] + phaseI, sinI, cosI);
+		sinCosOf(phaseScale * vQ[m] + phaseQ, sinQ, cosQ);
+		re[m] = amplitude * ((t_real) sinI - leakage * (t_real) cosQ);
+		im[m] = amplitude * (leakage * (t_real) cosI + (t_real) sinQ);
+	}
+}
+
+/* Square root of a positive normal x as x / sqrt(x), with the inverse square root from the exponent halving guess refined by Newton
+steps: the relative error, below 0.035 at first, is squared by each step. */
+DSP_INLINE double sqrtOf(double x) {
+	double y = doubleOfBits(0x5FE6EB50C7B537A9ULL - (bitsOfDouble(x) >> 1));
+	for (int step = 0; step < 4; step++) y = y * (1.5 - 0.5 * x * y * y);
+	return x * y;
+}
+
+// The uniforms are built from the top 52 bits of the words by setting the exponent of 1: u1 in [2^-53, 1 - 2^-53], u2 in [0, 1).
+DSP_INLINE void boxMuller(const uint64_t *words, t_real *out, int n) {
+	for (int p = 0; p < n; p++) {
+		double u1 = (1.0 - 0x1.0p-53) - (doubleOfBits(0x3FF0000000000000ULL | (words[2 * p] >> 12)) - 1.0);
+		double u2 = doubleOfBits(0x3FF0000000000000ULL | (words[2 * p + 1] >> 12)) - 1.0;
+		double radius = sqrtOf(-2.0 * logOf(u1));
+		double sinX, cosX;
+		sinCosOf(6.28318530717958647693 * u2, sinX, cosX);
+		out[2 * p] = (t_real)(radius * cosX);
+		out[2 * p + 1] = (t_real)(radius * sinX);
+	}
+}
+
+/* One radix-2 decimation in time stage over the blocks of 2 * half values: x[j] + w[j] x[j + half], x[j] - w[j] x[j + half], j < span.
+The complex products are written out on the real and imaginary parts, without the NaN recovery of the std::complex product. */
+DSP_INLINE void fftStage(t_complex *x, const t_complex *twiddles, int half, int span, int n) {
+	const t_real *w = reinterpret_cast<const t_real *>(twiddles);
+	for (int block = 0; block < n; block += 2 * half) {
+		t_real *a = reinterpret_cast<t_real *>(x + block);
+		t_real *b = a + 2 * half;
+		for (int j = 0; j < span; j++) {
+			t_real re = b[2 * j] * w[2 * j] - b[2 * j + 1] * w[2 * j + 1];
+			t_real im = b[2 * j] * w[2 * j + 1] + b[2 * j + 1] * w[2 * j];
+			b[2 * j] = a[2 * j] - re;
+			b[2 * j + 1] = a[2 * j + 1] - im;
+			a[2 * j] = a[2 * j] + re;
+			a[2 * j + 1] = a[2 * j + 1] + im;
+		}
+	}
+}
+
+// The peak power is tracked on the bits of the powers, which order as the powers themselves, so that the loop stays free of float compares.
+DSP_INLINE t_real kerrPhase(t_complex *x, t_real scale, int n) {
+	t_real *v = reinterpret_cast<t_real *>(x);
+	uint64_t peakBits = 0;
+	for (int m = 0; m < n; m++) {
+		double re = v[2 * m], im = v[2 * m + 1];
+		double power = re * re + im * im;
+		uint64_t powerBits = bitsOfDouble(power);
+		peakBits = (powerBits > peakBits) ? powerBits : peakBits;
+		double sinX, cosX;
+		sinCosOf(scale * power, sinX, cosX);
+		v[2 * m] = (t_real)(re * cosX - im * sinX);
+		v[2 * m + 1] = (t_real)(re * sinX + im * cosX);
+	}
+	return (t_real) doubleOfBits(peakBits);
+}
+
+DSP_INLINE void dispersionStep(t_complex *x, const t_real *phase, t_real length, t_real gain, int n) {
+	t_real *v = reinterpret_cast<t_real *>(x);
+	for (int m = 0; m < n; m++) {
+		double sinX, cosX;
+		sinCosOf(length * phase[m], sinX, cosX);
+		double re = gain * v[2 * m], im = gain * v[2 * m + 1];
+		v[2 * m] = (t_real)(re * cosX - im * sinX);
+		v[2 * m + 1] = (t_real)(re * sinX + im * cosX);
+	}
+}
+
+// Eight partial sums in a fixed order, which the compiler keeps in vector lanes; the tail goes to the first ones.
+DSP_INLINE double sumOfSquares(const t_real *x, int n) {
+	double partial[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+	int m = 0;
+	for (; m + 8 <= n; m += 8) {
+		for (int j = 0; j < 8; j++) partial[j] = partial[j] + (double) x[m + j] * x[m + j];
+	}
+	for (int j = 0; m < n; m++, j++) partial[j] = partial[j] + (double) x[m] * x[m];
+	return ((partial[0] + partial[4]) + (partial[1] + partial[5])) + ((partial[2] + partial[6]) + (partial[3] + partial[7]));
+}
+
+DSP_INLINE void realScaleAdd(const t_real *in, t_real scale, const t_real *noise, t_real noiseScale, t_real *out, int n) {
+	for (int m = 0; m < n; m++) out[m] = scale * in[m] + noiseScale * noise[m];
+}
+
+// The matrix of sample m is matrices[m * step], step 0 for a single matrix.
+DSP_INLINE void jonesApply(const t_complex_xy *in, const t_jones *matrices, int step, t_complex_xy *out, int n) {
+	for (int m = 0; m < n; m++) {
+		const t_jones &j = matrices[m * step];
+		t_real xr = in[m].x.real(), xi = in[m].x.imag();
+		t_real yr = in[m].y.real(), yi = in[m].y.imag();
+		t_real re = j.xx.real() * xr - j.xx.imag() * xi + j.xy.real() * yr - j.xy.imag() * yi;
+		t_real im = j.xx.real() * xi + j.xx.imag() * xr + j.xy.real() * yi + j.xy.imag() * yr;
+		out[m].x = t_complex(re, im);
+		re = j.yx.real() * xr - j.yx.imag() * xi + j.yy.real() * yr - j.yy.imag() * yi;
+		im = j.yx.real() * xi + j.yx.imag() * xr + j.yy.real() * yi + j.yy.imag() * yr;
+		out[m].y = t_complex(re, im);
+	}
+}
+
+static void realScaleScalar(const t_real *in, t_real scale, t_real *out, int n) { realScale(in, scale, out, n); }
+
+static void splitComplexMultiplyScalar(const t_real *aRe, const t_real *aIm, const t_real *bRe, const t_real *bIm, t_real *outRe, t_real *outIm, int n) {
+	splitComplexMultiply(aRe, aIm, bRe, bIm, outRe, outIm, n);
+}
+
+static void thresholdBitsScalar(const uint64_t *values, uint64_t threshold, t_binary *bits, int n) { thresholdBits(values, threshold, bits, n); }
+
+static void philoxScalar(uint64_t key, uint64_t stream, uint64_t firstBlock, uint64_t *out, int n) { philox(key, stream, firstBlock, out, n); }
+
+static void sinCosScalar(const t_real *x, t_real *s, t_real *c, int n) { sinCos(x, s, c, n); }
+
+static void polarScalar(const t_real *magnitude, const t_real *phase, t_real *re, t_real *im, int n) { polar(magnitude, phase, re, im, n); }
+
+static void boxMullerScalar(const uint64_t *words, t_real *out, int n) { boxMuller(words, out, n); }
+
+static void iqMachZehnderScalar(const t_real *vI, const t_real *vQ, t_real phaseScale, t_real phaseI, t_real phaseQ, t_real leakage, t_real amplitude, t_real *re, t_real *im, int n) {
+	iqMachZehnder(vI, vQ, phaseScale, phaseI, phaseQ, leakage, amplitude, re, im, n);
+}
+
+static void fftStageScalar(t_complex *x, const t_complex *twiddles, int half, int span, int n) { fftStage(x, twiddles, half, span, n); }
+
+static t_real kerrPhaseScalar(t_complex *x, t_real scale, int n) { return kerrPhase(x, scale, n); }
+
+static void dispersionStepScalar(t_complex *x, const t_real *phase, t_real length, t_real gain, int n) { dispersionStep(x, phase, length, gain, n); }
+
+static double sumOfSquaresScalar(const t_real *x, int n) { return sumOfSquares(x, n); }
+
+static void realScaleAddScalar(const t_real *in, t_real scale, const t_real *noise, t_real noiseScale, t_real *out, int n) {
+	realScaleAdd(in, scale, noise, noiseScale, out, n);
+}
+
+static void jonesMatrixScalar(const t_complex_xy *in, const t_jones *matrix, t_complex_xy *out, int n) { jonesApply(in, matrix, 0, out, n); }
+
+static void jonesMatricesScalar(const t_complex_xy *in, const t_jones *matrices, t_complex_xy *out, int n) { jonesApply(in, matrices, 1, out, n); }
+
+static long long fixedDotProductScalar(const t_fixed *x, const t_fixed *h, int n) {
+	long long value{ 0 };
+	for (int m = 0; m < n; m++) value += (t_integer)x[m] * h[m];
+	return value;
+}
+
+# ifdef DSP_KERNELS_X86
+
+//########################################################################################################################################################
+//############################################################### AVX2 KERNELS ############################################################################
+//########################################################################################################################################################
+
+# ifndef NETPLUS_SINGLE_PRECISION
+
+DSP_TARGET_AVX2 static t_real dotProductAvx2(const t_real *x, const t_real *h, int n) {
+	__m256d acc0 = _mm256_setzero_pd();
+	__m256d acc1 = _mm256_setzero_pd();
+	int m = 0;
+	for (; m + 8 <= n; m += 8) {
+		acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + m), _mm256_loadu_pd(h + m), acc0);
+		acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + m + 4), _mm256_loadu_pd(h + m + 4), acc1);
+	}
+	for (; m + 4 <= n; m += 4) acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + m), _mm256_loadu_pd(h + m), acc0);
+
+	acc0 = _mm256_add_pd(acc0, acc1);
+	__m128d aux = _mm_add_pd(_mm256_castpd256_pd128(acc0), _mm256_extractf128_pd(acc0, 1));
+	t_real value = _mm_cvtsd_f64(_mm_add_sd(aux, _mm_unpackhi_pd(aux, aux)));
+
+	for (; m < n; m++) value += x[m] * h[m];
+	return value;
+}
+
+DSP_TARGET_AVX2 static t_complex complexDotProductAvx2(const t_complex *x, const t_real *h, int n) {
+	const t_real *iq = reinterpret_cast<const t_real *>(x);
+	__m256d acc = _mm256_setzero_pd();
+	int m = 0;
+	for (; m + 2 <= n; m += 2) {
+		// (h0, h0, h1, h1) against (re0, im0, re1, im1)
+		__m256d taps = _mm256_permute4x64_pd(_mm256_castpd128_pd256(_mm_loadu_pd(h + m)), 0x50);
+		acc = _mm256_fmadd_pd(_mm256_loadu_pd(iq + 2 * m), taps, acc);
+	}
+	__m128d aux = _mm_add_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+	t_real re = _mm_cvtsd_f64(aux);
+	t_real im = _mm_cvtsd_f64(_mm_unpackhi_pd(aux, aux));
+
+	for (; m < n; m++) {
+		re += iq[2 * m] * h[m];
+		im += iq[2 * m + 1] * h[m];
+	}
+	return t_complex(re, im);
+}
+
+DSP_TARGET_AVX2 static void complexScaleAvx2(const t_complex *in, t_real scale, t_complex *out, int n) {
+	const t_real *src = reinterpret_cast<const t_real *>(in);
+	t_real *dst = reinterpret_cast<t_real *>(out);
+	__m256d s = _mm256_set1_pd(scale);
+	int m = 0;
+	for (; m + 2 <= n; m += 2) _mm256_storeu_pd(dst + 2 * m, _mm256_mul_pd(_mm256_loadu_pd(src + 2 * m), s));
+	for (; m < n; m++) out[m] = scale * in[m];
+}
+
+DSP_TARGET_AVX2 static void complexMultiplyAvx2(const t_complex *a, const t_complex *b, t_complex *out, int n) {
+	const t_real *pa = reinterpret_cast<const t_real *>(a);
+	const t_real *pb = reinterpret_cast<const t_real *>(b);
+	t_real *dst = reinterpret_cast<t_real *>(out);
+	int m = 0;
+	for (; m + 2 <= n; m += 2) {
+		__m256d va = _mm256_loadu_pd(pa + 2 * m);
+		__m256d vb = _mm256_loadu_pd(pb + 2 * m);
+		__m256d aRe = _mm256_movedup_pd(va);				// (ar, ar)
+		__m256d aIm = _mm256_permute_pd(va, 0xF);			// (ai, ai)
+		__m256d bSwap = _mm256_permute_pd(vb, 0x5);			// (bi, br)
+		_mm256_storeu_pd(dst + 2 * m, _mm256_fmaddsub_pd(aRe, vb, _mm256_mul_pd(aIm, bSwap)));
+	}
+	complexMultiplyScalar(a + m, b + m, out + m, n - m);
+}
+
+// Stages shorter than a vector are left to the generic loop.
+DSP_TARGET_AVX2 static void fftStageAvx2(t_complex *x, const t_complex *twiddles, int half, int span, int n) {
+	if (span < 2) {
+		fftStage(x, twiddles, half, span, n);
+		return;
+	}
+	const t_real *w = reinterpret_cast<const t_real *>(twiddles);
+	for (int block = 0; block < n; block += 2 * half) {
+		t_real *a = reinterpret_cast<t_real *>(x + block);
+		t_real *b = a + 2 * half;
+		for (int j = 0; j < span; j += 2) {
+			__m256d vw = _mm256_loadu_pd(w + 2 * j);
+			__m256d vb = _mm256_loadu_pd(b + 2 * j);
+			__m256d va = _mm256_loadu_pd(a + 2 * j);
+			__m256d product = _mm256_fmaddsub_pd(_mm256_movedup_pd(vw), vb, _mm256_mul_pd(_mm256_permute_pd(vw, 0xF), _mm256_permute_pd(vb, 0x5)));
+			_mm256_storeu_pd(a + 2 * j, _mm256_add_pd(va, product));
+			_mm256_storeu_pd(b + 2 * j, _mm256_sub_pd(va, product));
+		}
+	}
+}
+
+DSP_TARGET_AVX2 static void interleaveAvx2(const t_real *re, const t_real *im, t_complex *out, int n) {
+	t_real *dst = reinterpret_cast<t_real *>(out);
+	int m = 0;
+	for (; m + 4 <= n; m += 4) {
+		__m256d vr = _mm256_loadu_pd(re + m);
+		__m256d vi = _mm256_loadu_pd(im + m);
+		__m256d lo = _mm256_unpacklo_pd(vr, vi);			// (r0, i0, r2, i2)
+		__m256d hi = _mm256_unpackhi_pd(vr, vi);			// (r1, i1, r3, i3)
+		_mm256_storeu_pd(dst + 2 * m, _mm256_permute2f128_pd(lo, hi, 0x20));
+		_mm256_storeu_pd(dst + 2 * m + 4, _mm256_permute2f128_pd(lo, hi, 0x31));
+	}
+	interleaveScalar(re + m, im + m, out + m, n - m);
+}
+
+DSP_TARGET_AVX2 static void deinterleaveAvx2(const t_complex *in, t_real *re, t_real *im, int n) {
+	const t_real *src = reinterpret_cast<const t_real *>(in);
+	int m = 0;
+	for (; m + 4 <= n; m += 4) {
+		__m256d a = _mm256_loadu_pd(src + 2 * m);			// (r0, i0, r1, i1)
+		__m256d b = _mm256_loadu_pd(src + 2 * m + 4);		// (r2, i2, r3, i3)
+		__m256d lo = _mm256_permute2f128_pd(a, b, 0x20);	// (r0, i0, r2, i2)
+		__m256d hi = _mm256_permute2f128_pd(a, b, 0x31);	// (r1, i1, r3, i3)
+		_mm256_storeu_pd(re + m, _mm256_unpacklo_pd(lo, hi));
+		_mm256_storeu_pd(im + m, _mm256_unpackhi_pd(lo, hi));
+	}
+	deinterleaveScalar(in + m, re + m, im + m, n - m);
+}
+
+// One dual-polarization sample per vector, (x, y): diag(xx, yy) (x, y) + diag(xy, yx) (y, x).
+DSP_TARGET_AVX2 DSP_INLINE __m256d jonesProductAvx2(__m256d v, __m256d dRe, __m256d dIm, __m256d oRe, __m256d oIm) {
+	__m256d s = _mm256_permute2f128_pd(v, v, 0x01);				// (y, x)
+	__m256d p = _mm256_fmaddsub_pd(dRe, v, _mm256_mul_pd(dIm, _mm256_permute_pd(v, 0x5)));
+	__m256d q = _mm256_fmaddsub_pd(oRe, s, _mm256_mul_pd(oIm, _mm256_permute_pd(s, 0x5)));
+	return _mm256_add_pd(p, q);
+}
+
+DSP_TARGET_AVX2 static void jonesMatrixAvx2(const t_complex_xy *in, const t_jones *matrix, t_complex_xy *out, int n) {
+	const t_real *src = reinterpret_cast<const t_real *>(in);
+	const t_real *pm = reinterpret_cast<const t_real *>(matrix);
+	t_real *dst = reinterpret_cast<t_real *>(out);
+	__m256d d = _mm256_loadu_pd(pm);							// (xx, yy)
+	__m256d o = _mm256_loadu_pd(pm + 4);						// (xy, yx)
+	__m256d dRe = _mm256_movedup_pd(d), dIm = _mm256_permute_pd(d, 0xF);
+	__m256d oRe = _mm256_movedup_pd(o), oIm = _mm256_permute_pd(o, 0xF);
+	for (int m = 0; m < n; m++) _mm256_storeu_pd(dst + 4 * m, jonesProductAvx2(_mm256_loadu_pd(src + 4 * m), dRe, dIm, oRe, oIm));
+}
+
+DSP_TARGET_AVX2 static void jonesMatricesAvx2(const t_complex_xy *in, const t_jones *matrices, t_complex_xy *out, int n) {
+	const t_real *src = reinterpret_cast<const t_real *>(in);
+	const t_real *pm = reinterpret_cast<const t_real *>(matrices);
+	t_real *dst = reinterpret_cast<t_real *>(out);
+	for (int m = 0; m < n; m++) {
+		__m256d d = _mm256_loadu_pd(pm + 8 * m);
+		__m256d o = _mm256_loadu_pd(pm + 8 * m + 4);
+		__m256d v = jonesProductAvx2(_mm256_loadu_pd(src + 4 * m), _mm256_movedup_pd(d), _mm256_permute_pd(d, 0xF), _mm256_movedup_pd(o), _mm256_permute_pd(o, 0xF));
+		_mm256_storeu_pd(dst + 4 * m, v);
+	}
+}
+
+# else
+
+DSP_TARGET_AVX2 static t_real dotProductAvx2(const t_real *x, const t_real *h, int n) {
+	__m256 acc0 = _mm256_setzero_ps();
+	__m256 acc1 = _mm256_setzero_ps();
+	int m = 0;
+	for (; m + 16 <= n; m += 16) {
+		acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + m), _mm256_loadu_ps(h + m), acc0);
+		acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(x + m + 8), _mm256_loadu_ps(h + m + 8), acc1);
+	}
+	for (; m + 8 <= n; m += 8) acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + m), _mm256_loadu_ps(h + m), acc0);
+
+	acc0 = _mm256_add_ps(acc0, acc1);
+	__m128 aux = _mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1));
+	aux = _mm_add_ps(aux, _mm_movehl_ps(aux, aux));
+	t_real value = _mm_cvtss_f32(_mm_add_ss(aux, _mm_movehdup_ps(aux)));
+
+	for (; m < n; m++) value += x[m] * h[m];
+	return value;
+}
+
+DSP_TARGET_AVX2 static t_complex complexDotProductAvx2(const t_complex *x, const t_real *h, int n) {
+	const t_real *iq = reinterpret_cast<const t_real *>(x);
+	const __m256i duplicate = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+	__m256 acc = _mm256_setzero_ps();
+	int m = 0;
+	for (; m + 4 <= n; m += 4) {
+		// (h0, h0, h1, h1, h2, h2, h3, h3) against (re0, im0, re1, im1, re2, im2, re3, im3)
+		__m256 taps = _mm256_permutevar8x32_ps(_mm256_castps128_ps256(_mm_loadu_ps(h + m)), duplicate);
+		acc = _mm256_fmadd_ps(_mm256_loadu_ps(iq + 2 * m), taps, acc);
+	}
+	__m128 aux = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+	aux = _mm_add_ps(aux, _mm_movehl_ps(aux, aux));
+	t_real re = _mm_cvtss_f32(aux);
+	t_real im = _mm_cvtss_f32(_mm_movehdup_ps(aux));
+
+	for (; m < n; m++) {
+		re += iq[2 * m] * h[m];
+		im += iq[2 * m + 1] * h[m];
+	}
+	return t_complex(re, im);
+}
+
+DSP_TARGET_AVX2 static void complexScaleAvx2(const t_complex *in, t_real scale, t_complex *out, int n) {
+	const t_real *src = reinterpret_cast<const t_real *>(in);
+	t_real *dst = reinterpret_cast<t_real *>(out);
+	__m256 s = _mm256_set1_ps(scale);
+	int m = 0;
+	for (; m + 4 <= n; m += 4) _mm256_storeu_ps(dst + 2 * m, _mm256_mul_ps(_mm256_loadu_ps(src + 2 * m), s));
+	for (; m < n; m++) out[m] = scale * in[m];
+}
+
+DSP_TARGET_AVX2 static void complexMultiplyAvx2(const t_complex *a, const t_complex *b, t_complex *out, int n) {
+	const t_real *pa = reinterpret_cast<const t_real *>(a);
+	const t_real *pb = reinterpret_cast<const t_real *>(b);
+	t_real *dst = reinterpret_cast<t_real *>(out);
+	int m = 0;
+	for (; m + 4 <= n; m += 4) {
+		__m256 va = _mm256_loadu_ps(pa + 2 * m);
+		__m256 vb = _mm256_loadu_ps(pb + 2 * m);
+		__m256 aRe = _mm256_moveldup_ps(va);				// (ar, ar)
+		__m256 aIm = _mm256_movehdup_ps(va);				// (ai, ai)
+		__m256 bSwap = _mm256_permute_ps(vb, 0xB1);			// (bi, br)
+		_mm256_storeu_ps(dst + 2 * m, _mm256_fmaddsub_ps(aRe, vb, _mm256_mul_ps(aIm, bSwap)));
+	}
+	complexMultiplyScalar(a + m, b + m, out + m, n - m);
+}
+
+DSP_TARGET_AVX2 static void fftStageAvx2(t_complex *x, const t_complex *twiddles, int half, int span, int n) {
+	if (span < 4) {
+		fftStage(x, twiddles, half, span, n);
+		return;
+	}
+	const t_real *w = reinterpret_cast<const t_real *>(twiddles);
+	for (int block = 0; block < n; block += 2 * half) {
+		t_real *a = reinterpret_cast<t_real *>(x + block);
+		t_real *b = a + 2 * half;
+		for (int j = 0; j < span; j += 4) {
+			__m256 vw = _mm256_loadu_ps(w + 2 * j);
+			__m256 vb = _mm256_loadu_ps(b + 2 * j);
+			__m256 va = _mm256_loadu_ps(a + 2 * j);
+			__m256 product = _mm256_fmaddsub_ps(_mm256_moveldup_ps(vw), vb, _mm256_mul_ps(_mm256_movehdup_ps(vw), _mm256_permute_ps(vb, 0xB1)));
+			_mm256_storeu_ps(a + 2 * j, _mm256_add_ps(va, product));
+			_mm256_storeu_ps(b + 2 * j, _mm256_sub_ps(va, product));
+		}
+	}
+}
+
+DSP_TARGET_AVX2 static void interleaveAvx2(const t_real *re, const t_real *im, t_complex *out, int n) {
+	t_real *dst = reinterpret_cast<t_real *>(out);
+	int m = 0;
+	for (; m + 8 <= n; m += 8) {
+		__m256 vr = _mm256_loadu_ps(re + m);
+		__m256 vi = _mm256_loadu_ps(im + m);
+		__m256 lo = _mm256_unpacklo_ps(vr, vi);				// (r0, i0, r1, i1, r4, i4, r5, i5)
+		__m256 hi = _mm256_unpackhi_ps(vr, vi);				// (r2, i2, r3, i3, r6, i6, r7, i7)
+		_mm256_storeu_ps(dst + 2 * m, _mm256_permute2f128_ps(lo, hi, 0x20));
+		_mm256_storeu_ps(dst + 2 * m + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+	}
+	interleaveScalar(re + m, im + m, out + m, n - m);
+}
+
+DSP_TARGET_AVX2 static void deinterleaveAvx2(const t_complex *in, t_real *re, t_real *im, int n) {
+	const t_real *src = reinterpret_cast<const t_real *>(in);
+	int m = 0;
+	for (; m + 8 <= n; m += 8) {
+		__m256 a = _mm256_loadu_ps(src + 2 * m);			// (r0, i0, r1, i1, r2, i2, r3, i3)
+		__m256 b = _mm256_loadu_ps(src + 2 * m + 8);		// (r4, i4, r5, i5, r6, i6, r7, i7)
+		__m256 vr = _mm256_shuffle_ps(a, b, 0x88);			// (r0, r1, r4, r5, r2, r3, r6, r7)
+		__m256 vi = _mm256_shuffle_ps(a, b, 0xDD);
+		_mm256_storeu_ps(re + m, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(vr), 0xD8)));
+		_mm256_storeu_ps(im + m, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(vi), 0xD8)));
+	}
+	deinterleaveScalar(in + m, re + m, im + m, n - m);
+}
+
+// Two dual-polarization samples per vector, (x0, y0, x1, y1): diag(xx, yy) (x, y) + diag(xy, yx) (y, x).
+DSP_TARGET_AVX2 DSP_INLINE __m256 jonesProductAvx2(__m256 v, __m256 dRe, __m256 dIm, __m256 oRe, __m256 oIm) {
+	__m256 s = _mm256_permute_ps(v, 0x4E);						// (y0, x0, y1, x1)
+	__m256 p = _mm256_fmaddsub_ps(dRe, v, _mm256_mul_ps(dIm, _mm256_permute_ps(v, 0xB1)));
+	__m256 q = _mm256_fmaddsub_ps(oRe, s, _mm256_mul_ps(oIm, _mm256_permute_ps(s, 0xB1)));
+	return _mm256_add_ps(p, q);
+}
+
+DSP_TARGET_AVX2 static void jonesMatrixAvx2(const t_complex_xy *in, const t_jones *matrix, t_complex_xy *out, int n) {
+	const t_real *src = reinterpret_cast<const t_real *>(in);
+	const t_real *pm = reinterpret_cast<const t_real *>(matrix);
+	t_real *dst = reinterpret_cast<t_real *>(out);
+	__m256 d = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(pm));		// (xx, yy, xx, yy)
+	__m256 o = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(pm + 4));	// (xy, yx, xy, yx)
+	__m256 dRe = _mm256_moveldup_ps(d), dIm = _mm256_movehdup_ps(d);
+	__m256 oRe = _mm256_moveldup_ps(o), oIm = _mm256_movehdup_ps(o);
+	int m = 0;
+	for (; m + 2 <= n; m += 2) _mm256_storeu_ps(dst + 4 * m, jonesProductAvx2(_mm256_loadu_ps(src + 4 * m), dRe, dIm, oRe, oIm));
+	jonesMatrixScalar(in + m, matrix, out + m, n - m);
+}
+
+DSP_TARGET_AVX2 static void jonesMatricesAvx2(const t_complex_xy *in, const t_jones *matrices, t_complex_xy *out, int n) {
+	const t_real *src = reinterpret_cast<const t_real *>(in);
+	const t_real *pm = reinterpret_cast<const t_real *>(matrices);
+	t_real *dst = reinterpret_cast<t_real *>(out);
+	int m = 0;
+	for (; m + 2 <= n; m += 2) {
+		__m256 j0 = _mm256_loadu_ps(pm + 8 * m);					// (xx0, yy0, xy0, yx0)
+		__m256 j1 = _mm256_loadu_ps(pm + 8 * m + 8);
+		__m256 d = _mm256_permute2f128_ps(j0, j1, 0x20);			// (xx0, yy0, xx1, yy1)
+		__m256 o = _mm256_permute2f128_ps(j0, j1, 0x31);			// (xy0, yx0, xy1, yx1)
+		__m256 v = jonesProductAvx2(_mm256_loadu_ps(src + 4 * m), _mm256_moveldup_ps(d), _mm256_movehdup_ps(d), _mm256_moveldup_ps(o), _mm256_movehdup_ps(o));
+		_mm256_storeu_ps(dst + 4 * m, v);
+	}
+	jonesMatricesScalar(in + m, matrices + m, out + m, n - m);
+}
+
+# endif
+
+DSP_TARGET_AVX2 static void unpackBitsAvx2(const uint64_t *words, t_binary *bits, int n) {
+	const __m256i masks = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+	const __m256i ones = _mm256_set1_epi32(1);
+	int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		int byte = (int)((words[i >> 6] >> (i & 63)) & 0xFF);
+		__m256i v = _mm256_and_si256(_mm256_set1_epi32(byte), masks);
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(bits + i), _mm256_min_epu32(v, ones));
+	}
+	for (; i < n; i++) bits[i] = (t_binary)((words[i >> 6] >> (i & 63)) & 1);
+}
+
+// Each pair of products fits in 32 bits as long as the taps avoid -32768, the pair sums are accumulated in 64 bits.
+DSP_TARGET_AVX2 static long long fixedDotProductAvx2(const t_fixed *x, const t_fixed *h, int n) {
+	__m256i acc = _mm256_setzero_si256();
+	int m = 0;
+	for (; m + 16 <= n; m += 16) {
+		__m256i vx = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + m));
+		__m256i vh = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(h + m));
+		__m256i pairs = _mm256_madd_epi16(vx, vh);
+		acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(pairs)));
+		acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(pairs, 1)));
+	}
+	long long lanes[4];
+	_mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), acc);
+	long long value = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+
+	for (; m < n; m++) value += (t_integer)x[m] * h[m];
+	return value;
+}
+
+DSP_TARGET_AVX2 static void realScaleAvx2(const t_real *in, t_real scale, t_real *out, int n) { realScale(in, scale, out, n); }
+
+DSP_TARGET_AVX2 static void splitComplexMultiplyAvx2(const t_real *aRe, const t_real *aIm, const t_real *bRe, const t_real *bIm, t_real *outRe, t_real *outIm, int n) {
+	splitComplexMultiply(aRe, aIm, bRe, bIm, outRe, outIm, n);
+}
+
+DSP_TARGET_AVX2 static void thresholdBitsAvx2(const uint64_t *values, uint64_t threshold, t_binary *bits, int n) { thresholdBits(values, threshold, bits, n); }
+
+DSP_TARGET_AVX2 static void philoxAvx2(uint64_t key, uint64_t stream, uint64_t firstBlock, uint64_t *out, int n) { philox(key, stream, firstBlock, out, n); }
+
+DSP_TARGET_AVX2 static void sinCosAvx2(const t_real *x, t_real *s, t_real *c, int n) { sinCos(x, s, c, n); }
+
+DSP_TARGET_AVX2 static void polarAvx2(const t_real *magnitude, const t_real *phase, t_real *re, t_real *im, int n) { polar(magnitude, phase, re, im, n); }
+
+DSP_TARGET_AVX2 static void boxMullerAvx2(const uint64_t *words, t_real *out, int n) { boxMuller(words, out, n); }
+
+DSP_TARGET_AVX2 static void iqMachZehnderAvx2(const t_real *vI, const t_real *vQ, t_real phaseScale, t_real phaseI, t_real phaseQ, t_real leakage, t_real amplitude, t_real *re, t_real *im, int n) {
+	iqMachZehnder(vI, vQ, phaseScale, phaseI, phaseQ, leakage, amplitude, re, im, n);
+}
+
+DSP_TARGET_AVX2 static t_real kerrPhaseAvx2(t_complex *x, t_real scale, int n) { return kerrPhase(x, scale, n); }
+
+DSP_TARGET_AVX2 static void dispersionStepAvx2(t_complex *x, const t_real *phase, t_real length, t_real gain, int n) { dispersionStep(x, phase, length, gain, n); }
+
+DSP_TARGET_AVX2 static double sumOfSquaresAvx2(const t_real *x, int n) { return sumOfSquares(x, n); }
+
+DSP_TARGET_AVX2 static void realScaleAddAvx2(const t_real *in, t_real scale, const t_real *noise, t_real noiseScale, t_real *out, int n) {
+	realScaleAdd(in, scale, noise, noiseScale, out, n);
+}
+
+//########################################################################################################################################################
+//############################################################### AVX-512 KERNELS #########################################################################
+//########################################################################################################################################################
+
+/* GCC 12 reports the undefined pass-through operand of its own unmasked AVX-512 permutes, broadcasts and reductions as uninitialized.
+The kernels use the zero-masked forms with every lane selected, which compile to the same instructions, and masked loads for the half vectors. */
+const __mmask8 ALL_PD = 0xFF;
+const __mmask16 ALL_PS = 0xFFFF;
+
+# ifndef NETPLUS_SINGLE_PRECISION
+
+DSP_TARGET_AVX512 DSP_INLINE t_real reduceAddAvx512(__m512d v) {
+	__m256d sum = _mm256_add_pd(_mm512_maskz_extractf64x4_pd(0x0F, v, 0), _mm512_maskz_extractf64x4_pd(0x0F, v, 1));
+	__m128d aux = _mm_add_pd(_mm256_castpd256_pd128(sum), _mm256_extractf128_pd(sum, 1));
+	return _mm_cvtsd_f64(_mm_add_sd(aux, _mm_unpackhi_pd(aux, aux)));
+}
+
+DSP_TARGET_AVX512 static t_real dotProductAvx512(const t_real *x, const t_real *h, int n) {
+	__m512d acc0 = _mm512_setzero_pd();
+	__m512d acc1 = _mm512_setzero_pd();
+	int m = 0;
+	for (; m + 16 <= n; m += 16) {
+		acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(x + m), _mm512_loadu_pd(h + m), acc0);
+		acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(x + m + 8), _mm512_loadu_pd(h + m + 8), acc1);
+	}
+	if (m + 8 <= n) {
+		acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(x + m), _mm512_loadu_pd(h + m), acc0);
+		m += 8;
+	}
+	if (m < n) {
+		__mmask8 tail = (__mmask8)((1u << (n - m)) - 1);
+		acc1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(tail, x + m), _mm512_maskz_loadu_pd(tail, h + m), acc1);
+	}
+	return reduceAddAvx512(_mm512_add_pd(acc0, acc1));
+}
+
+DSP_TARGET_AVX512 static t_complex complexDotProductAvx512(const t_complex *x, const t_real *h, int n) {
+	const t_real *iq = reinterpret_cast<const t_real *>(x);
+	const __m512i duplicate = _mm512_setr_epi64(0, 0, 1, 1, 2, 2, 3, 3);
+	__m512d acc = _mm512_setzero_pd();
+	int m = 0;
+	for (; m + 4 <= n; m += 4) {
+		__m512d taps = _mm512_maskz_permutexvar_pd(ALL_PD, duplicate, _mm512_maskz_loadu_pd(0x0F, h + m));
+		acc = _mm512_fmadd_pd(_mm512_loadu_pd(iq + 2 * m), taps, acc);
+	}
+	if (m < n) {
+		__mmask8 tail = (__mmask8)((1u << (n - m)) - 1);
+		__mmask8 tailIq = (__mmask8)((1u << (2 * (n - m))) - 1);
+		__m512d taps = _mm512_maskz_permutexvar_pd(ALL_PD, duplicate, _mm512_maskz_loadu_pd(tail, h + m));
+		acc = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(tailIq, iq + 2 * m), taps, acc);
+	}
+	t_real re = reduceAddAvx512(_mm512_maskz_mov_pd(0x55, acc));
+	t_real im = reduceAddAvx512(_mm512_maskz_mov_pd(0xAA, acc));
+	return t_complex(re, im);
+}
+
+DSP_TARGET_AVX512 static void complexScaleAvx512(const t_complex *in, t_real scale, t_complex *out, int n) {
+	const t_real *src = reinterpret_cast<const t_real *>(in);
+	t_real *dst = reinterpret_cast<t_real *>(out);
+	__m512d s = _mm512_set1_pd(scale);
+	int m = 0;
+	for (; m + 4 <= n; m += 4) _mm512_storeu_pd(dst + 2 * m, _mm512_mul_pd(_mm512_loadu_pd(src + 2 * m), s));
+	if (m < n) {
+		__mmask8 tail = (__mmask8)((1u << (2 * (n - m))) - 1);
+		_mm512_mask_storeu_pd(dst + 2 * m, tail, _mm512_mul_pd(_mm512_maskz_loadu_pd(tail, src + 2 * m), s));
+	}
+}
+
+DSP_TARGET_AVX512 static void complexMultiplyAvx512(const t_complex *a, const t_complex *b, t_complex *out, int n) {
+	const t_real *pa = reinterpret_cast<const t_real *>(a);
+	const t_real *pb = reinterpret_cast<const t_real *>(b);
+	t_real *dst = reinterpret_cast<t_real *>(out);
+	int m = 0;
+	for (; m + 4 <= n; m += 4) {
+		__m512d va = _mm512_loadu_pd(pa + 2 * m);
+		__m512d vb = _mm512_loadu_pd(pb + 2 * m);
+		__m512d aRe = _mm512_maskz_movedup_pd(ALL_PD, va);
+		__m512d aIm = _mm512_maskz_permute_pd(ALL_PD, va, 0xFF);
+		__m512d bSwap = _mm512_maskz_permute_pd(ALL_PD, vb, 0x55);
+		_mm512_storeu_pd(dst + 2 * m, _mm512_fmaddsub_pd(aRe, vb, _mm512_mul_pd(aIm, bSwap)));
+	}
+	complexMultiplyScalar(a + m, b + m, out + m, n - m);
+}
+
+DSP_TARGET_AVX512 static void fftStageAvx512(t_complex *x, const t_complex *twiddles, int half, int span, int n) {
+	if (span < 4) {
+		fftStage(x, twiddles, half, span, n);
+		return;
+	}
+	const t_real *w = reinterpret_cast<const t_real *>(twiddles);
+	for (int block = 0; block < n; block += 2 * half) {
+		t_real *a = reinterpret_cast<t_real *>(x + block);
+		t_real *b = a + 2 * half;
+		for (int j = 0; j < span; j += 4) {
+			__m512d vw = _mm512_loadu_pd(w + 2 * j);
+			__m512d vb = _mm512_loadu_pd(b + 2 * j);
+			__m512d va = _mm512_loadu_pd(a + 2 * j);
+			__m512d product = _mm512_fmaddsub_pd(_mm512_maskz_movedup_pd(ALL_PD, vw), vb, _mm512_mul_pd(_mm512_maskz_permute_pd(ALL_PD, vw, 0xFF), _mm512_maskz_permute_pd(ALL_PD, vb, 0x55)));
+			_mm512_storeu_pd(a + 2 * j, _mm512_add_pd(va, product));
+			_mm512_storeu_pd(b + 2 * j, _mm512_sub_pd(va, product));
+		}
+	}
+}
+
+DSP_TARGET_AVX512 static void interleaveAvx512(const t_real *re, const t_real *im, t_complex *out, int n) {
+	t_real *dst = reinterpret_cast<t_real *>(out);
+	const __m512i lo = _mm512_setr_epi64(0, 8, 1, 9, 2, 10, 3, 11);
+	const __m512i hi = _mm512_setr_epi64(4, 12, 5, 13, 6, 14, 7, 15);
+	int m = 0;
+	for (; m + 8 <= n; m += 8) {
+		__m512d vr = _mm512_loadu_pd(re + m);
+		__m512d vi = _mm512_loadu_pd(im + m);
+		_mm512_storeu_pd(dst + 2 * m, _mm512_permutex2var_pd(vr, lo, vi));
+		_mm512_storeu_pd(dst + 2 * m + 8, _mm512_permutex2var_pd(vr, hi, vi));
+	}
+	interleaveScalar(re + m, im + m, out + m, n - m);
+}
+
+DSP_TARGET_AVX512 static void deinterleaveAvx512(const t_complex *in, t_real *re, t_real *im, int n) {
+	const t_real *src = reinterpret_cast<const t_real *>(in);
+	const __m512i even = _mm512_setr_epi64(0, 2, 4, 6, 8, 10, 12, 14);
+	const __m512i odd = _mm512_setr_epi64(1, 3, 5, 7, 9, 11, 13, 15);
+	int m = 0;
+	for (; m + 8 <= n; m += 8) {
+		__m512d a = _mm512_loadu_pd(src + 2 * m);
+		__m512d b = _mm512_loadu_pd(src + 2 * m + 8);
+		_mm512_storeu_pd(re + m, _mm512_permutex2var_pd(a, even, b));
+		_mm512_storeu_pd(im + m, _mm512_permutex2var_pd(a, odd, b));
+	}
+	deinterleaveScalar(in + m, re + m, im + m, n - m);
+}
+
+// Two dual-polarization samples per vector, (x0, y0, x1, y1): diag(xx, yy) (x, y) + diag(xy, yx) (y, x).
+DSP_TARGET_AVX512 DSP_INLINE __m512d jonesProductAvx512(__m512d v, __m512d dRe, __m512d dIm, __m512d oRe, __m512d oIm) {
+	__m512d s = _mm512_maskz_permutex_pd(ALL_PD, v, 0x4E);					// (y0, x0, y1, x1)
+	__m512d p = _mm512_fmaddsub_pd(dRe, v, _mm512_mul_pd(dIm, _mm512_maskz_permute_pd(ALL_PD, v, 0x55)));
+	__m512d q = _mm512_fmaddsub_pd(oRe, s, _mm512_mul_pd(oIm, _mm512_maskz_permute_pd(ALL_PD, s, 0x55)));
+	return _mm512_add_pd(p, q);
+}
+
+DSP_TARGET_AVX512 static void jonesMatrixAvx512(const t_complex_xy *in, const t_jones *matrix, t_complex_xy *out, int n) {
+	const t_real *src = reinterpret_cast<const t_real *>(in);
+	const t_real *pm = reinterpret_cast<const t_real *>(matrix);
+	t_real *dst = reinterpret_cast<t_real *>(out);
+	__m512d d = _mm512_maskz_broadcast_f64x4(ALL_PD, _mm256_loadu_pd(pm));		// (xx, yy, xx, yy)
+	__m512d o = _mm512_maskz_broadcast_f64x4(ALL_PD, _mm256_loadu_pd(pm + 4));	// (xy, yx, xy, yx)
+	__m512d dRe = _mm512_maskz_movedup_pd(ALL_PD, d), dIm = _mm512_maskz_permute_pd(ALL_PD, d, 0xFF);
+	__m512d oRe = _mm512_maskz_movedup_pd(ALL_PD, o), oIm = _mm512_maskz_permute_pd(ALL_PD, o, 0xFF);
+	int m = 0;
+	for (; m + 2 <= n; m += 2) _mm512_storeu_pd(dst + 4 * m, jonesProductAvx512(_mm512_loadu_pd(src + 4 * m), dRe, dIm, oRe, oIm));
+	jonesMatrixScalar(in + m, matrix, out + m, n - m);
+}
+
+DSP_TARGET_AVX512 static void jonesMatricesAvx512(const t_complex_xy *in, const t_jones *matrices, t_complex_xy *out, int n) {
+	const t_real *src = reinterpret_cast<const t_real *>(in);
+	const t_real *pm = reinterpret_cast<const t_real *>(matrices);
+	t_real *dst = reinterpret_cast<t_real *>(out);
+	int m = 0;
+	for (; m + 2 <= n; m += 2) {
+		__m512d j0 = _mm512_loadu_pd(pm + 8 * m);					// (xx0, yy0, xy0, yx0)
+		__m512d j1 = _mm512_loadu_pd(pm + 8 * m + 8);
+		__m512d d = _mm512_maskz_shuffle_f64x2(ALL_PD, j0, j1, 0x44);			// (xx0, yy0, xx1, yy1)
+		__m512d o = _mm512_maskz_shuffle_f64x2(ALL_PD, j0, j1, 0xEE);			// (xy0, yx0, xy1, yx1)
+		__m512d v = jonesProductAvx512(_mm512_loadu_pd(src + 4 * m), _mm512_maskz_movedup_pd(ALL_PD, d), _mm512_maskz_permute_pd(ALL_PD, d, 0xFF), _mm512_maskz_movedup_pd(ALL_PD, o), _mm512_maskz_permute_pd(ALL_PD, o, 0xFF));
+		_mm512_storeu_pd(dst + 4 * m, v);
+	}
+	jonesMatricesScalar(in + m, matrices + m, out + m, n - m);
+}
+
+# else
+
+DSP_TARGET_AVX512 DSP_INLINE t_real reduceAddAvx512(__m512 v) {
+	__m256 low = _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0x0F, _mm512_castps_pd(v), 0));
+	__m256 high = _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0x0F, _mm512_castps_pd(v), 1));
+	__m256 sum = _mm256_add_ps(low, high);
+	__m128 aux = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+	aux = _mm_add_ps(aux, _mm_movehl_ps(aux, aux));
+	return _mm_cvtss_f32(_mm_add_ss(aux, _mm_movehdup_ps(aux)));
+}
+
+DSP_TARGET_AVX512 static t_real dotProductAvx512(const t_real *x, const t_real *h, int n) {
+	__m512 acc0 = _mm512_setzero_ps();
+	__m512 acc1 = _mm512_setzero_ps();
+	int m = 0;
+	for (; m + 32 <= n; m += 32) {
+		acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(x + m), _mm512_loadu_ps(h + m), acc0);
+		acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(x + m + 16), _mm512_loadu_ps(h + m + 16), acc1);
+	}
+	if (m + 16 <= n) {
+		acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(x + m), _mm512_loadu_ps(h + m), acc0);
+		m += 16;
+	}
+	if (m < n) {
+		__mmask16 tail = (__mmask16)((1u << (n - m)) - 1);
+		acc1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(tail, x + m), _mm512_maskz_loadu_ps(tail, h + m), acc1);
+	}
+	return reduceAddAvx512(_mm512_add_ps(acc0, acc1));
+}
+
+DSP_TARGET_AVX512 static t_complex complexDotProductAvx512(const t_complex *x, const t_real *h, int n) {
+	const t_real *iq = reinterpret_cast<const t_real *>(x);
+	const __m512i duplicate = _mm512_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7);
+	__m512 acc = _mm512_setzero_ps();
+	int m = 0;
+	for (; m + 8 <= n; m += 8) {
+		__m512 taps = _mm512_maskz_permutexvar_ps(ALL_PS, duplicate, _mm512_maskz_loadu_ps(0x00FF, h + m));
+		acc = _mm512_fmadd_ps(_mm512_loadu_ps(iq + 2 * m), taps, acc);
+	}
+	if (m < n) {
+		__mmask16 tail = (__mmask16)((1u << (n - m)) - 1);
+		__mmask16 tailIq = (__mmask16)((1u << (2 * (n - m))) - 1);
+		__m512 taps = _mm512_maskz_permutexvar_ps(ALL_PS, duplicate, _mm512_maskz_loadu_ps(tail, h + m));
+		acc = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(tailIq, iq + 2 * m), taps, acc);
+	}
+	t_real re = reduceAddAvx512(_mm512_maskz_mov_ps(0x5555, acc));
+	t_real im = reduceAddAvx512(_mm512_maskz_mov_ps(0xAAAA, acc));
+	return t_complex(re, im);
+}
+
+DSP_TARGET_AVX512 static void complexScaleAvx512(const t_complex *in, t_real scale, t_complex *out, int n) {
+	const t_real *src = reinterpret_cast<const t_real *>(in);
+	t_real *dst = reinterpret_cast<t_real *>(out);
+	__m512 s = _mm512_set1_ps(scale);
+	int m = 0;
+	for (; m + 8 <= n; m += 8) _mm512_storeu_ps(dst + 2 * m, _mm512_mul_ps(_mm512_loadu_ps(src + 2 * m), s));
+	if (m < n) {
+		__mmask16 tail = (__mmask16)((1u << (2 * (n - m))) - 1);
+		_mm512_mask_storeu_ps(dst + 2 * m, tail, _mm512_mul_ps(_mm512_maskz_loadu_ps(tail, src + 2 * m), s));
+	}
+}
+
+DSP_TARGET_AVX512 static void complexMultiplyAvx512(const t_complex *a, const t_complex *b, t_complex *out, int n) {
+	const t_real *pa = reinterpret_cast<const t_real *>(a);
+	const t_real *pb = reinterpret_cast<const t_real *>(b);
+	t_real *dst = reinterpret_cast<t_real *>(out);
+	int m = 0;
+	for (; m + 8 <= n; m += 8) {
+		__m512 va = _mm512_loadu_ps(pa + 2 * m);
+		__m512 vb = _mm512_loadu_ps(pb + 2 * m);
+		__m512 aRe = _mm512_maskz_moveldup_ps(ALL_PS, va);
+		__m512 aIm = _mm512_maskz_movehdup_ps(ALL_PS, va);
+		__m512 bSwap = _mm512_maskz_permute_ps(ALL_PS, vb, 0xB1);
+		_mm512_storeu_ps(dst + 2 * m, _mm512_fmaddsub_ps(aRe, vb, _mm512_mul_ps(aIm, bSwap)));
+	}
+	complexMultiplyScalar(a + m, b + m, out + m, n - m);
+}
+
+DSP_TARGET_AVX512 static void fftStageAvx512(t_complex *x, const t_complex *twiddles, int half, int span, int n) {
+	if (span < 8) {
+		fftStage(x, twiddles, half, span, n);
+		return;
+	}
+	const t_real *w = reinterpret_cast<const t_real *>(twiddles);
+	for (int block = 0; block < n; block += 2 * half) {
+		t_real *a = reinterpret_cast<t_real *>(x + block);
+		t_real *b = a + 2 * half;
+		for (int j = 0; j < span; j += 8) {
+			__m512 vw = _mm512_loadu_ps(w + 2 * j);
+			__m512 vb = _mm512_loadu_ps(b + 2 * j);
+			__m512 va = _mm512_loadu_ps(a + 2 * j);
+			__m512 product = _mm512_fmaddsub_ps(_mm512_maskz_moveldup_ps(ALL_PS, vw), vb, _mm512_mul_ps(_mm512_maskz_movehdup_ps(ALL_PS, vw), _mm512_maskz_permute_ps(ALL_PS, vb, 0xB1)));
+			_mm512_storeu_ps(a + 2 * j, _mm512_add_ps(va, product));
+			_mm512_storeu_ps(b + 2 * j, _mm512_sub_ps(va, product));
+		}
+	}
+}
+
+DSP_TARGET_AVX512 static void interleaveAvx512(const t_real *re, const t_real *im, t_complex *out, int n) {
+	t_real *dst = reinterpret_cast<t_real *>(out);
+	const __m512i lo = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+	const __m512i hi = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+	int m = 0;
+	for (; m + 16 <= n; m += 16) {
+		__m512 vr = _mm512_loadu_ps(re + m);
+		__m512 vi = _mm512_loadu_ps(im + m);
+		_mm512_storeu_ps(dst + 2 * m, _mm512_permutex2var_ps(vr, lo, vi));
+		_mm512_storeu_ps(dst + 2 * m + 16, _mm512_permutex2var_ps(vr, hi, vi));
+	}
+	interleaveScalar(re + m, im + m, out + m, n - m);
+}
+
+DSP_TARGET_AVX512 static void deinterleaveAvx512(const t_complex *in, t_real *re, t_real *im, int n) {
+	const t_real *src = reinterpret_cast<const t_real *>(in);
+	const __m512i even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+	const __m512i odd = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+	int m = 0;
+	for (; m + 16 <= n; m += 16) {
+		__m512 a = _mm512_loadu_ps(src + 2 * m);
+		__m512 b = _mm512_loadu_ps(src + 2 * m + 16);
+		_mm512_storeu_ps(re + m, _mm512_permutex2var_ps(a, even, b));
+		_mm512_storeu_ps(im + m, _mm512_permutex2var_ps(a, odd, b));
+	}
+	deinterleaveScalar(in + m, re + m, im + m, n - m);
+}
+
+// Four dual-polarization samples per vector, (x0, y0, ..., x3, y3): diag(xx, yy) (x, y) + diag(xy, yx) (y, x).
+DSP_TARGET_AVX512 DSP_INLINE __m512 jonesProductAvx512(__m512 v, __m512 dRe, __m512 dIm, __m512 oRe, __m512 oIm) {
+	__m512 s = _mm512_maskz_permute_ps(ALL_PS, v, 0x4E);						// (y0, x0, ..., y3, x3)
+	__m512 p = _mm512_fmaddsub_ps(dRe, v, _mm512_mul_ps(dIm, _mm512_maskz_permute_ps(ALL_PS, v, 0xB1)));
+	__m512 q = _mm512_fmaddsub_ps(oRe, s, _mm512_mul_ps(oIm, _mm512_maskz_permute_ps(ALL_PS, s, 0xB1)));
+	return _mm512_add_ps(p, q);
+}
+
+DSP_TARGET_AVX512 static void jonesMatrixAvx512(const t_complex_xy *in, const t_jones *matrix, t_complex_xy *out, int n) {
+	const t_real *src = reinterpret_cast<const t_real *>(in);
+	const t_real *pm = reinterpret_cast<const t_real *>(matrix);
+	t_real *dst = reinterpret_cast<t_real *>(out);
+	__m512 d = _mm512_maskz_broadcast_f32x4(ALL_PS, _mm_loadu_ps(pm));			// (xx, yy, ..., xx, yy)
+	__m512 o = _mm512_maskz_broadcast_f32x4(ALL_PS, _mm_loadu_ps(pm + 4));		// (xy, yx, ..., xy, yx)
+	__m512 dRe = _mm512_maskz_moveldup_ps(ALL_PS, d), dIm = _mm512_maskz_movehdup_ps(ALL_PS, d);
+	__m512 oRe = _mm512_maskz_moveldup_ps(ALL_PS, o), oIm = _mm512_maskz_movehdup_ps(ALL_PS, o);
+	int m = 0;
+	for (; m + 4 <= n; m += 4) _mm512_storeu_ps(dst + 4 * m, jonesProductAvx512(_mm512_loadu_ps(src + 4 * m), dRe, dIm, oRe, oIm));
+	jonesMatrixScalar(in + m, matrix, out + m, n - m);
+}
+
+DSP_TARGET_AVX512 static void jonesMatricesAvx512(const t_complex_xy *in, const t_jones *matrices, t_complex_xy *out, int n) {
+	const t_real *src = reinterpret_cast<const t_real *>(in);
+	const t_real *pm = reinterpret_cast<const t_real *>(matrices);
+	t_real *dst = reinterpret_cast<t_real *>(out);
+	int m = 0;
+	for (; m + 4 <= n; m += 4) {
+		__m512 j0 = _mm512_loadu_ps(pm + 8 * m);					// (xx0, yy0, xy0, yx0, xx1, yy1, xy1, yx1)
+		__m512 j1 = _mm512_loadu_ps(pm + 8 * m + 16);
+		__m512 d = _mm512_maskz_shuffle_f32x4(ALL_PS, j0, j1, 0x88);				// (xx0, yy0, ..., xx3, yy3)
+		__m512 o = _mm512_maskz_shuffle_f32x4(ALL_PS, j0, j1, 0xDD);				// (xy0, yx0, ..., xy3, yx3)
+		__m512 v = jonesProductAvx512(_mm512_loadu_ps(src + 4 * m), _mm512_maskz_moveldup_ps(ALL_PS, d), _mm512_maskz_movehdup_ps(ALL_PS, d), _mm512_maskz_moveldup_ps(ALL_PS, o), _mm512_maskz_movehdup_ps(ALL_PS, o));
+		_mm512_storeu_ps(dst + 4 * m, v);
+	}
+	jonesMatricesScalar(in + m, matrices + m, out + m, n - m);
+}
+
+# endif
+
+DSP_TARGET_AVX512 static void unpackBitsAvx512(const uint64_t *words, t_binary *bits, int n) {
+	const __m512i ones = _mm512_set1_epi32(1);
+	int i = 0;
+	for (; i + 16 <= n; i += 16) {
+		__mmask16 mask = (__mmask16)((words[i >> 6] >> (i & 63)) & 0xFFFF);
+		_mm512_storeu_si512(bits + i, _mm512_maskz_mov_epi32(mask, ones));
+	}
+	for (; i < n; i++) bits[i] = (t_binary)((words[i >> 6] >> (i & 63)) & 1);
+}
+
+// As fixedDotProductAvx2, 32 taps per multiply-add; the tail is read with a masked load instead of a scalar loop.
+DSP_TARGET_AVX512 static long long fixedDotProductAvx512(const t_fixed *x, const t_fixed *h, int n) {
+	__m512i acc = _mm512_setzero_si512();
+	for (int m = 0; m < n; m += 32) {
+		__mmask32 lanes = (n - m >= 32) ? 0xFFFFFFFF : (__mmask32)((1U << (n - m)) - 1);
+		__m512i pairs = _mm512_madd_epi16(_mm512_maskz_loadu_epi16(lanes, x + m), _mm512_maskz_loadu_epi16(lanes, h + m));
+		acc = _mm512_add_epi64(acc, _mm512_maskz_cvtepi32_epi64(0xFF, _mm512_maskz_extracti64x4_epi64(0x0F, pairs, 0)));
+		acc = _mm512_add_epi64(acc, _mm512_maskz_cvtepi32_epi64(0xFF, _mm512_maskz_extracti64x4_epi64(0x0F, pairs, 1)));
+	}
+	long long lanes[8];
+	_mm512_storeu_si512(lanes, acc);
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+}
+
+DSP_TARGET_AVX512 static void realScaleAvx512(const t_real *in, t_real scale, t_real *out, int n) { realScale(in, scale, out, n); }
+
+DSP_TARGET_AVX512 static void splitComplexMultiplyAvx512(const t_real *aRe, const t_real *aIm, const t_real *bRe, const t_real *bIm, t_real *outRe, t_real *outIm, int n) {
+	splitComplexMultiply(aRe, aIm, bRe, bIm, outRe, outIm, n);
+}
+
+DSP_TARGET_AVX512 static void thresholdBitsAvx512(const uint64_t *values, uint64_t threshold, t_binary *bits, int n) { thresholdBits(values, threshold, bits, n); }
+
+DSP_TARGET_AVX512 static void philoxAvx512(uint64_t key, uint64_t stream, uint64_t firstBlock, uint64_t *out, int n) { philox(key, stream, firstBlock, out, n); }
+
+DSP_TARGET_AVX512 static void sinCosAvx512(const t_real *x, t_real *s, t_real *c, int n) { sinCos(x, s, c, n); }
+
+DSP_TARGET_AVX512 static void polarAvx512(const t_real *magnitude, const t_real *phase, t_real *re, t_real *im, int n) { polar(magnitude, phase, re, im, n); }
+
+DSP_TARGET_AVX512 static void boxMullerAvx512(const uint64_t *words, t_real *out, int n) { boxMuller(words, out, n); }
+
+DSP_TARGET_AVX512 static void iqMachZehnderAvx512(const t_real *vI, const t_real *vQ, t_real phaseScale, t_real phaseI, t_real phaseQ, t_real leakage, t_real amplitude, t_real *re, t_real *im, int n) {
+	iqMachZehnder(vI, vQ, phaseScale, phaseI, phaseQ, leakage, amplitude, re, im, n);
+}
+
+
+DSP_TARGET_AVX512 static t_real kerrPhaseAvx512(t_complex *x, t_real scale, int n) { return kerrPhase(x, scale, n); }
+
+DSP_TARGET_AVX512 static void dispersionStepAvx512(t_complex *x, const t_real *phase, t_real length, t_real gain, int n) { dispersionStep(x, phase, length, gain, n); }
+
+DSP_TARGET_AVX512 static double sumOfSquaresAvx512(const t_real *x, int n) { return sumOfSquares(x, n); }
+
+DSP_TARGET_AVX512 static void realScaleAddAvx512(const t_real *in, t_real scale, const t_real *noise, t_real noiseScale, t_real *out, int n) {
+	realScaleAdd(in, scale, noise, noiseScale, out, n);
+}
+
+# endif
+
+//########################################################################################################################################################
+//############################################################### DISPATCH ################################################################################
+//########################################################################################################################################################
+
+static const DspKernels scalarKernels = { ScalarIsa, dotProductScalar, complexDotProductScalar, complexScaleScalar, complexMultiplyScalar,
+	interleaveScalar, deinterleaveScalar, unpackBitsScalar, fixedDotProductScalar,
+	realScaleScalar, splitComplexMultiplyScalar, thresholdBitsScalar, philoxScalar,
+	sinCosScalar, iqMachZehnderScalar, polarScalar, boxMullerScalar,
+	fftStageScalar, kerrPhaseScalar, dispersionStepScalar, sumOfSquaresScalar, realScaleAddScalar,
+	jonesMatrixScalar, jonesMatricesScalar };
+
+# ifdef DSP_KERNELS_X86
+static const DspKernels avx2Kernels = { Avx2Isa, dotProductAvx2, complexDotProductAvx2, complexScaleAvx2, complexMultiplyAvx2,
+	interleaveAvx2, deinterleaveAvx2, unpackBitsAvx2, fixedDotProductAvx2,
+	realScaleAvx2, splitComplexMultiplyAvx2, thresholdBitsAvx2, philoxAvx2,
+	sinCosAvx2, iqMachZehnderAvx2, polarAvx2, boxMullerAvx2,
+	fftStageAvx2, kerrPhaseAvx2, dispersionStepAvx2, sumOfSquaresAvx2, realScaleAddAvx2,
+	jonesMatrixAvx2, jonesMatricesAvx2 };
+
+static const DspKernels avx512Kernels = { Avx512Isa, dotProductAvx512, complexDotProductAvx512, complexScaleAvx512, complexMultiplyAvx512,
+	interleaveAvx512, deinterleaveAvx512, unpackBitsAvx512, fixedDotProductAvx512,
+	realScaleAvx512, splitComplexMultiplyAvx512, thresholdBitsAvx512, philoxAvx512,
+	sinCosAvx512, iqMachZehnderAvx512, polarAvx512, boxMullerAvx512,
+	fftStageAvx512, kerrPhaseAvx512, dispersionStepAvx512, sumOfSquaresAvx512, realScaleAddAvx512,
+	jonesMatrixAvx512, jonesMatricesAvx512 };
+# endif
+
+DspIsa detectDspIsa(void) {
+
+# if defined(DSP_KERNELS_X86) && defined(_MSC_VER)
+	int regs[4];
+
+	__cpuid(regs, 0);
+	if (regs[0] < 7) return ScalarIsa;
+
+	__cpuid(regs, 1);
+	bool fma = (regs[2] & (1 << 12)) != 0;
+	bool osxsave = (regs[2] & (1 << 27)) != 0;
+	bool avx = (regs[2] & (1 << 28)) != 0;
+	if (!(fma && osxsave && avx)) return ScalarIsa;
+
+	// The operating system must save the YMM (and for AVX-512 the ZMM and opmask) registers.
+	unsigned long long xcr0 = _xgetbv(0);
+	if ((xcr0 & 0x6) != 0x6) return ScalarIsa;
+
+	__cpuidex(regs, 7, 0);
+	bool avx2 = (regs[1] & (1 << 5)) != 0;
+	bool avx512f = (regs[1] & (1 << 16)) != 0;
+	bool avx512bw = (regs[1] & (1 << 30)) != 0;
+	if (!avx2) return ScalarIsa;
+	if (avx512f && avx512bw && ((xcr0 & 0xE6) == 0xE6)) return Avx512Isa;
+	return Avx2Isa;
+# elif defined(DSP_KERNELS_X86)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) return Avx512Isa;
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return Avx2Isa;
+	return ScalarIsa;
+# else
+	return ScalarIsa;
+# endif
+
+}
+
+string dspIsaName(DspIsa isa) {
+	switch (isa) {
+		case Avx2Isa:
+			return "avx2";
+		case Avx512Isa:
+			return "avx512";
+		default:
+			return "scalar";
+	}
+}
+
+const DspKernels &getDspKernels(DspIsa isa) {
+# ifdef DSP_KERNELS_X86
+	if (isa == Avx512Isa) return avx512Kernels;
+	if (isa == Avx2Isa) return avx2Kernels;
+# endif
+	return scalarKernels;
+}
+
+static string environmentVariable(const char *name) {
+# if defined(_MSC_VER)
+	char *value{ nullptr };
+	size_t length{ 0 };
+	if ((_dupenv_s(&value, &length, name) != 0) || (value == nullptr)) return "";
+	string aux(value);
+	free(value);
+	return aux;
+# else
+	const char *value = getenv(name);
+	return (value == nullptr) ? "" : string(value);
+# endif
+}
+
+static const DspKernels &selectDspKernels(void) {
+
+	DspIsa isa = detectDspIsa();
+
+	string requested = environmentVariable("NETPLUS_ISA");
+	if (!requested.empty()) {
+		DspIsa forced = isa;
+		if (requested == "scalar") forced = ScalarIsa;
+		else if (requested == "avx2") forced = Avx2Isa;
+		else if (requested == "avx512") forced = Avx512Isa;
+		else cerr << "NETPLUS_ISA=" << requested << " is not a valid level (scalar, avx2, avx512), using " << dspIsaName(isa) << endl;
+
+		if (forced > isa)
+			cerr << "NETPLUS_ISA=" << requested << " is not supported by this processor, using " << dspIsaName(isa) << endl;
+		else
+			isa = forced;
+	}
+
+	return getDspKernels(isa);
+}
+
+const DspKernels &dspKernels(void) {
+	static const DspKernels &kernels = selectDspKernels();
+	return kernels;
+}
+
+//########################################################################################################################################################
+//############################################################### POLYPHASE FIR KERNELS ###################################################################
+//########################################################################################################################################################
+
+// The generic bodies are inlined in one wrapper per level, so the compiler unrolls and vectorizes them for that instruction set.
+template<int SPS, int TAPS>
+DSP_INLINE void polyphaseFir(const t_real *window, const t_real *taps, t_real *out) {
+	t_real acc[SPS];
+	for (int p = 0; p < SPS; p++) acc[p] = 0.0;
+	for (int m = 0; m < TAPS; m++) {
+		t_real x = window[m];
+		for (int p = 0; p < SPS; p++) acc[p] += x * taps[m * SPS + p];
+	}
+	for (int p = 0; p < SPS; p++) out[p] = acc[p];
+}
+
+template<int SPS, int TAPS>
+DSP_INLINE void complexPolyphaseFir(const t_complex *window, const t_real *taps, t_complex *out) {
+	const t_real *iq = reinterpret_cast<const t_real *>(window);
+	t_real re[SPS];
+	t_real im[SPS];
+	for (int p = 0; p < SPS; p++) {
+		re[p] = 0.0;
+		im[p] = 0.0;
+	}
+	for (int m = 0; m < TAPS; m++) {
+		t_real xRe = iq[2 * m];
+		t_real xIm = iq[2 * m + 1];
+		for (int p = 0; p < SPS; p++) {
+			re[p] += xRe * taps[m * SPS + p];
+			im[p] += xIm * taps[m * SPS + p];
+		}
+	}
+	for (int p = 0; p < SPS; p++) out[p] = t_complex(re[p], im[p]);
+}
+
+template<int SPS, int TAPS>
+static void polyphaseFirScalar(const t_real *window, const t_real *taps, t_real *out) { polyphaseFir<SPS, TAPS>(window, taps, out); }
+
+template<int SPS, int TAPS>
+static void complexPolyphaseFirScalar(const t_complex *window, const t_real *taps, t_complex *out) { complexPolyphaseFir<SPS, TAPS>(window, taps, out); }
+
+# ifdef DSP_KERNELS_X86
+template<int SPS, int TAPS>
+DSP_TARGET_AVX2 static void polyphaseFirAvx2(const t_real *window, const t_real *taps, t_real *out) { polyphaseFir<SPS, TAPS>(window, taps, out); }
+
+template<int SPS, int TAPS>
+DSP_TARGET_AVX2 static void complexPolyphaseFirAvx2(const t_complex *window, const t_real *taps, t_complex *out) { complexPolyphaseFir<SPS, TAPS>(window, taps, out); }
+
+template<int SPS, int TAPS>
+DSP_TARGET_AVX512 static void polyphaseFirAvx512(const t_real *window, const t_real *taps, t_real *out) { polyphaseFir<SPS, TAPS>(window, taps, out); }
+
+template<int SPS, int TAPS>
+DSP_TARGET_AVX512 static void complexPolyphaseFirAvx512(const t_complex *window, const t_real *taps, t_complex *out) { complexPolyphaseFir<SPS, TAPS>(window, taps, out); }
+# endif
+
+template<int SPS, int TAPS>
+static PolyphaseFirKernel polyphaseFirOf(DspIsa isa) {
+# ifdef DSP_KERNELS_X86
+	if (isa == Avx512Isa) return polyphaseFirAvx512<SPS, TAPS>;
+	if (isa == Avx2Isa) return polyphaseFirAvx2<SPS, TAPS>;
+# endif
+	return polyphaseFirScalar<SPS, TAPS>;
+}
+
+template<int SPS, int TAPS>
+static ComplexPolyphaseFirKernel complexPolyphaseFirOf(DspIsa isa) {
+# ifdef DSP_KERNELS_X86
+	if (isa == Avx512Isa) return complexPolyphaseFirAvx512<SPS, TAPS>;
+	if (isa == Avx2Isa) return complexPolyphaseFirAvx2<SPS, TAPS>;
+# endif
+	return complexPolyphaseFirScalar<SPS, TAPS>;
+}
+
+template<int SPS>
+static PolyphaseFirKernel polyphaseFirOf(DspIsa isa, int tapsPerPhase) {
+	switch (tapsPerPhase) {
+		case 8:
+			return polyphaseFirOf<SPS, 8>(isa);
+		case 16:
+			return polyphaseFirOf<SPS, 16>(isa);
+		case 32:
+			return polyphaseFirOf<SPS, 32>(isa);
+		default:
+			return nullptr;
+	}
+}
+
+template<int SPS>
+static ComplexPolyphaseFirKernel complexPolyphaseFirOf(DspIsa isa, int tapsPerPhase) {
+	switch (tapsPerPhase) {
+		case 8:
+			return complexPolyphaseFirOf<SPS, 8>(isa);
+		case 16:
+			return complexPolyphaseFirOf<SPS, 16>(isa);
+		case 32:
+			return complexPolyphaseFirOf<SPS, 32>(isa);
+		default:
+			return nullptr;
+	}
+}
+
+PolyphaseFirKernel getPolyphaseFirKernel(int numberOfPhases, int tapsPerPhase) {
+	DspIsa isa = dspKernels().isa;
+	switch (numberOfPhases) {
+		case 8:
+			return polyphaseFirOf<8>(isa, tapsPerPhase);
+		case 16:
+			return polyphaseFirOf<16>(isa, tapsPerPhase);
+		case 32:
+			return polyphaseFirOf<32>(isa, tapsPerPhase);
+		default:
+			return nullptr;
+	}
+}
+
+ComplexPolyphaseFirKernel getComplexPolyphaseFirKernel(int numberOfPhases, int tapsPerPhase) {
+	DspIsa isa = dspKernels().isa;
+	switch (numberOfPhases) {
+		case 8:
+			return complexPolyphaseFirOf<8>(isa, tapsPerPhase);
+		case 16:
+			return complexPolyphaseFirOf<16>(isa, tapsPerPhase);
+		case 32:
+			return complexPolyphaseFirOf<32>(isa, tapsPerPhase);
+		default:
+			return nullptr;
+	}
+}
+
+//########################################################################################################################################################
+//############################################################### FIXED-POINT POLYPHASE FIR KERNELS #######################################################
+//########################################################################################################################################################
+
+template<int SPS, int TAPS>
+static void fixedPolyphaseFirScalar(const t_fixed *symbols, const t_fixed *taps, t_integer *out, int n) {
+	for (int s = 0; s < n; s++) {
+		for (int p = 0; p < SPS; p++) {
+			t_integer acc{ 0 };
+			for (int m = 0; m < TAPS; m++) acc += (t_integer)symbols[s + m] * taps[2 * ((m / 2) * SPS + p) + (m % 2)];
+			out[s * SPS + p] = acc;
+		}
+	}
+}
+
+# ifdef DSP_KERNELS_X86
+// Symbols 2k and 2k + 1 of the window, as the 32-bit word that the multiply-add pairs with the taps 2k and 2k + 1 of each branch.
+DSP_INLINE int symbolPair(const t_fixed *symbols) {
+	int pair;
+	memcpy(&pair, symbols, sizeof(pair));
+	return pair;
+}
+
+// Eight branches per 256-bit register.
+template<int SPS, int TAPS>
+DSP_TARGET_AVX2 static void fixedPolyphaseFirAvx2(const t_fixed *symbols, const t_fixed *taps, t_integer *out, int n) {
+	for (int s = 0; s < n; s++) {
+		__m256i acc[SPS / 8];
+		for (int g = 0; g < SPS / 8; g++) acc[g] = _mm256_setzero_si256();
+		for (int k = 0; k < TAPS / 2; k++) {
+			__m256i x = _mm256_set1_epi32(symbolPair(symbols + s + 2 * k));
+			for (int g = 0; g < SPS / 8; g++) {
+				__m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(taps + 2 * (k * SPS + 8 * g)));
+				acc[g] = _mm256_add_epi32(acc[g], _mm256_madd_epi16(x, h));
+			}
+		}
+		for (int g = 0; g < SPS / 8; g++) _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + s * SPS + 8 * g), acc[g]);
+	}
+}
+
+// Sixteen branches per 512-bit register; with 8 branches, two symbols per register.
+template<int SPS, int TAPS>
+DSP_TARGET_AVX512 static void fixedPolyphaseFirAvx512(const t_fixed *symbols, const t_fixed *taps, t_integer *out, int n) {
+	if (SPS == 8) {
+		int s = 0;
+		for (; s + 2 <= n; s += 2) {
+			__m512i acc = _mm512_setzero_si512();
+			for (int k = 0; k < TAPS / 2; k++) {
+				__m512i x = _mm512_mask_set1_epi32(_mm512_set1_epi32(symbolPair(symbols + s + 2 * k)), 0xFF00, symbolPair(symbols + s + 1 + 2 * k));
+				__m512i h = _mm512_maskz_broadcast_i64x4(0xFF, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(taps + 16 * k)));
+				acc = _mm512_add_epi32(acc, _mm512_madd_epi16(x, h));
+			}
+			_mm512_storeu_si512(out + s * 8, acc);
+		}
+		// An odd last symbol is shaped alone, the window of a next one is not there.
+		if (s < n) {
+			__m512i acc = _mm512_setzero_si512();
+			for (int k = 0; k < TAPS / 2; k++) {
+				__m512i x = _mm512_set1_epi32(symbolPair(symbols + s + 2 * k));
+				__m512i h = _mm512_maskz_broadcast_i64x4(0xFF, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(taps + 16 * k)));
+				acc = _mm512_add_epi32(acc, _mm512_madd_epi16(x, h));
+			}
+			_mm512_mask_storeu_epi32(out + s * 8, 0x00FF, acc);
+		}
+		return;
+	}
+	for (int s = 0; s < n; s++) {
+		__m512i acc[(SPS + 15) / 16];
+		for (int g = 0; g < SPS / 16; g++) acc[g] = _mm512_setzero_si512();
+		for (int k = 0; k < TAPS / 2; k++) {
+			__m512i x = _mm512_set1_epi32(symbolPair(symbols + s + 2 * k));
+			for (int g = 0; g < SPS / 16; g++) acc[g] = _mm512_add_epi32(acc[g], _mm512_madd_epi16(x, _mm512_loadu_si512(taps + 2 * (k * SPS + 16 * g))));
+		}
+		for (int g = 0; g < SPS / 16; g++) _mm512_storeu_si512(out + s * SPS + 16 * g, acc[g]);
+	}
+}
+# endif
+
+template<int SPS, int TAPS>
+static FixedPolyphaseFirKernel fixedPolyphaseFirOf(DspIsa isa) {
+# ifdef DSP_KERNELS_X86
+	if (isa == Avx512Isa) return fixedPolyphaseFirAvx512<SPS, TAPS>;
+	if (isa == Avx2Isa) return fixedPolyphaseFirAvx2<SPS, TAPS>;
+# endif
+	return fixedPolyphaseFirScalar<SPS, TAPS>;
+}
+
+template<int SPS>
+static FixedPolyphaseFirKernel fixedPolyphaseFirOf(DspIsa isa, int tapsPerPhase) {
+	switch (tapsPerPhase) {
+		case 8:
+			return fixedPolyphaseFirOf<SPS, 8>(isa);
+		case 16:
+			return fixedPolyphaseFirOf<SPS, 16>(isa);
+		case 32:
+			return fixedPolyphaseFirOf<SPS, 32>(isa);
+		default:
+			return nullptr;
+	}
+}
+
+FixedPolyphaseFirKernel getFixedPolyphaseFirKernel(int numberOfPhases, int tapsPerPhase) {
+	DspIsa isa = dspKernels().isa;
+	switch (numberOfPhases) {
+		case 8:
+			return fixedPolyphaseFirOf<8>(isa, tapsPerPhase);
+		case 16:
+			return fixedPolyphaseFirOf<16>(isa, tapsPerPhase);
+		case 32:
+			return fixedPolyphaseFirOf<32>(isa, tapsPerPhase);
+		default:
+			return nullptr;
+	}
+}
+
+bool fixedPolyphaseFirFits(const t_fixed *taps, int numberOfPhases, int tapsPerPhase, int maxSymbolCode) {
+	for (int p = 0; p < numberOfPhases; p++) {
+		long long sum{ 0 };
+		for (int m = 0; m < tapsPerPhase; m++) sum += abs((t_integer)taps[2 * ((m / 2) * numberOfPhases + p) + (m % 2)]);
+		if (sum * maxSymbolCode > 0x7FFFFFFFLL) return false;
+	}
+	return true;
+}
+
+//########################################################################################################################################################
+//############################################################### QAM MAPPER KERNELS ######################################################################
+//########################################################################################################################################################
+
+template<int BITS>
+DSP_INLINE void qamMapper(const t_binary *bits, t_real scale, t_real *i, t_real *q, int n) {
+	const int HALF = BITS / 2;
+	const int LEVELS = 1 << HALF;
+	for (int k = 0; k < n; k++) {
+		const t_binary *symbol = bits + BITS * k;
+		int grayI = 0, levelI = 0, grayQ = 0, levelQ = 0;
+		for (int b = 0; b < HALF; b++) {
+			grayI ^= (int)(symbol[b] & 1);
+			levelI = 2 * levelI + grayI;
+			grayQ ^= (int)(symbol[HALF + b] & 1);
+			levelQ = 2 * levelQ + grayQ;
+		}
+		i[k] = (t_real)(2 * levelI - (LEVELS - 1)) * scale;
+		q[k] = (t_real)(2 * levelQ - (LEVELS - 1)) * scale;
+	}
+}
+
+template<int BITS>
+DSP_INLINE void complexQamMapper(const t_binary *bits, t_real scale, t_complex *out, int n) {
+	t_real *iq = reinterpret_cast<t_real *>(out);
+	const int HALF = BITS / 2;
+	const int LEVELS = 1 << HALF;
+	for (int k = 0; k < n; k++) {
+		const t_binary *symbol = bits + BITS * k;
+		int grayI = 0, levelI = 0, grayQ = 0, levelQ = 0;
+		for (int b = 0; b < HALF; b++) {
+			grayI ^= (int)(symbol[b] & 1);
+			levelI = 2 * levelI + grayI;
+			grayQ ^= (int)(symbol[HALF + b] & 1);
+			levelQ = 2 * levelQ + grayQ;
+		}
+		iq[2 * k] = (t_real)(2 * levelI - (LEVELS - 1)) * scale;
+		iq[2 * k + 1] = (t_real)(2 * levelQ - (LEVELS - 1)) * scale;
+	}
+}
+
+template<int BITS>
+static void qamMapperScalar(const t_binary *bits, t_real scale, t_real *i, t_real *q, int n) { qamMapper<BITS>(bits, scale, i, q, n); }
+
+template<int BITS>
+static void complexQamMapperScalar(const t_binary *bits, t_real scale, t_complex *out, int n) { complexQamMapper<BITS>(bits, scale, out, n); }
+
+# ifdef DSP_KERNELS_X86
+template<int BITS>
+DSP_TARGET_AVX2 static void qamMapperAvx2(const t_binary *bits, t_real scale, t_real *i, t_real *q, int n) { qamMapper<BITS>(bits, scale, i, q, n); }
+
+template<int BITS>
+DSP_TARGET_AVX2 static void complexQamMapperAvx2(const t_binary *bits, t_real scale, t_complex *out, int n) { complexQamMapper<BITS>(bits, scale, out, n); }
+
+template<int BITS>
+DSP_TARGET_AVX512 static void qamMapperAvx512(const t_binary *bits, t_real scale, t_real *i, t_real *q, int n) { qamMapper<BITS>(bits, scale, i, q, n); }
+
+template<int BITS>
+DSP_TARGET_AVX512 static void complexQamMapperAvx512(const t_binary *bits, t_real scale, t_complex *out, int n) { complexQamMapper<BITS>(bits, scale, out, n); }
+# endif
+
+template<int BITS>
+static QamMapperKernel qamMapperOf(DspIsa isa) {
+# ifdef DSP_KERNELS_X86
+	if (isa == Avx512Isa) return qamMapperAvx512<BITS>;
+	if (isa == Avx2Isa) return qamMapperAvx2<BITS>;
+# endif
+	return qamMapperScalar<BITS>;
+}
+
+template<int BITS>
+static ComplexQamMapperKernel complexQamMapperOf(DspIsa isa) {
+# ifdef DSP_KERNELS_X86
+	if (isa == Avx512Isa) return complexQamMapperAvx512<BITS>;
+	if (isa == Avx2Isa) return complexQamMapperAvx2<BITS>;
+# endif
+	return complexQamMapperScalar<BITS>;
+}
+
+QamMapperKernel getQamMapperKernel(int bitsPerSymbol) {
+	DspIsa isa = dspKernels().isa;
+	switch (bitsPerSymbol) {
+		case 2:
+			return qamMapperOf<2>(isa);
+		case 4:
+			return qamMapperOf<4>(isa);
+		case 6:
+			return qamMapperOf<6>(isa);
+		default:
+			return nullptr;
+	}
+}
+
+ComplexQamMapperKernel getComplexQamMapperKernel(int bitsPerSymbol) {
+	DspIsa isa = dspKernels().isa;
+	switch (bitsPerSymbol) {
+		case 2:
+			return complexQamMapperOf<2>(isa);
+		case 4:
+			return complexQamMapperOf<4>(isa);
+		case 6:
+			return complexQamMapperOf<6>(isa);
+		default:
+			return nullptr;
+	}
+}
@@ -0,0 +1,93 @@
+# include <map>
+# include <mutex>
+# include <utility>		// swap
+
+# include "netplus.h"
+# include "fft.h"
+# include "dsp_kernels.h"
+# include "worker_pool.h"
+
+using namespace std;
+
+FftPlan::FftPlan(int n) : size(n) {
+
+	int bits = 0;
+	while ((1 << bits) < size) bits++;
+
+	for (int i = 0; i < size; i++) {
+		int j = 0;
+		for (int b = 0; b < bits; b++) j |= ((i >> b) & 1) << (bits - 1 - b);
+		if (i < j) {
+			swaps.push_back(i);
+			swaps.push_back(j);
+		}
+	}
+
+	// The twiddles are computed directly for each index, not by recurrence, so they are all accurate to the rounding of sin and cos.
+	forwardTwiddles.resize(max(size - 1, 1));
+	inverseTwiddles.resize(max(size - 1, 1));
+	for (int half = 1; half < size; half = 2 * half) {
+		for (int k = 0; k < half; k++) {
+			double angle = PI * k / half;
+			forwardTwiddles[half - 1 + k] = t_complex((t_real) cos(angle), (t_real)-sin(angle));
+			inverseTwiddles[half - 1 + k] = t_complex((t_real) cos(angle), (t_real) sin(angle));
+		}
+	}
+}
+
+// Transforms below FFT_PARALLEL_SIZE points are not worth the synchronization of the threads.
+const int FFT_PARALLEL_SIZE = 1 << 14;
+
+void FftPlan::transform(t_complex *x, const vector<t_complex> &twiddles, int numberOfThreads) const {
+
+	const DspKernels &kernels = dspKernels();
+
+	int threads = 1;
+	if (size >= FFT_PARALLEL_SIZE) while ((2 * threads <= numberOfThreads) && (2 * threads * threads * 64 <= size)) threads = 2 * threads;
+
+	if (threads == 1) {
+		for (size_t p = 0; p < swaps.size(); p += 2) swap(x[swaps[p]], x[swaps[p + 1]]);
+		for (int half = 1; half < size; half = 2 * half) kernels.fftStage(x, twiddles.data() + half - 1, half, half, size);
+		return;
+	}
+
+	// The swaps are disjoint, so they can be cut anywhere. Each chunk then goes through all the stages whose blocks fit in it, and the
+	// last stages are cut into pieces of span half / threads of every block, which are at least 32 points long.
+	int chunk = size / threads;
+	size_t numberOfSwaps = swaps.size() / 2;
+	workerPool().run(threads, [&](int t) {
+		for (size_t p = numberOfSwaps * t / threads; p < numberOfSwaps * (t + 1) / threads; p++) swap(x[swaps[2 * p]], x[swaps[2 * p + 1]]);
+	});
+	workerPool().run(threads, [&](int t) {
+		for (int half = 1; half < chunk; half = 2 * half) kernels.fftStage(x + t * chunk, twiddles.data() + half - 1, half, half, chunk);
+	});
+	for (int half = chunk; half < size; half = 2 * half) {
+		int span = half / threads;
+		workerPool().run(threads, [&](int t) {
+			kernels.fftStage(x + t * span, twiddles.data() + half - 1 + t * span, half, span, size);
+		});
+	}
+}
+
+void FftPlan::forward(t_complex *x, int numberOfThreads) const { transform(x, forwardTwiddles, numberOfThreads); }
+
+void FftPlan::inverse(t_complex *x, int numberOfThreads) const { transform(x, inverseTwiddles, numberOfThreads); }
+
+shared_ptr<const FftPlan> getFftPlan(int size) {
+
+	static mutex cacheMutex;
+	static map<int, shared_ptr<const FftPlan>> cache;
+
+	lock_guard<mutex> lock(cacheMutex);
+
+	shared_ptr<const FftPlan> &plan = cache[size];
+	if (!plan) plan = make_shared<const FftPlan>(size);
+
+	return plan;
+}
+
+int nextPowerOfTwo(int n) {
+	int p = 1;
+	while (p < n) p = 2 * p;
+	return p;
+}
@@ -0,0 +1,245 @@
+
+# include <algorithm>	// std::min, std::copy
+# include <math.h>
+
+# include "netplus.h"
+# include "fiber_span.h"
+# include "dsp_kernels.h"
+# include "worker_pool.h"
+
+using namespace std;
+
+void FiberSpan::initialize(void) {
+
+	firstTime = false;
+
+	Signal *in = inputSignals[0];
+	Signal *out = outputSignals[0];
+
+	out->setSymbolPeriod(in->getSymbolPeriod());
+	out->setSamplingPeriod(in->getSamplingPeriod());
+	out->setFirstValueToBeSaved(in->getFirstValueToBeSaved());
+	out->setCentralWavelength(in->getCentralWavelength());
+
+	// Fiber parameters in SI units.
+	double samplingPeriod = in->getSamplingPeriod();
+	double lambda = in->getCentralWavelength();
+	alpha = attenuation_dB_km * log(10.0) / 10 / 1e3;
+	gamma = nonlinearCoefficient_1_W_km / 1e3;
+	double beta2, beta3;
+	dispersionCoefficients(dispersion_ps_nm_km * 1e-6, dispersionSlope_ps_nm2_km * 1e3, lambda, beta2, beta3);
+
+	// The guard holds the impulse response of the dispersion of the whole span, by the energy criterion of OpticalFilter; the Kerr effect
+	// broadens the spectrum of high power signals, which may need a longer guardLength. The guard is rounded up to whole symbols, so that
+	// the output keeps the symbol timing of the input.
+	if (guardLength > 0) {
+		guard = guardLength;
+	}
+	else {
+		auto dispersion = [&](double f, complex<double> *h) {
+			double omega = 2 * PI * f;
+			h[0] = polar(1.0, (beta2 / 2 * omega * omega - beta3 / 6 * omega * omega * omega) * length);
+		};
+		guard = max(impulseResponseGuard(dispersion, 1, samplingPeriod, "FiberSpan"), 1);
+	}
+	guard = symbolAlignedGuard(guard, (int) round(in->getSamplesPerSymbol()));
+	frameSize = overlapSaveFrameSize(fftSize, guard);
+
+	plan = getFftPlan(frameSize);
+
+	dispersionPhase.resize(frameSize);
+	for (int k = 0; k < frameSize; k++) {
+		double omega = 2 * PI * binFrequency(k, frameSize, samplingPeriod);
+		dispersionPhase[k] = (t_real)(beta2 / 2 * omega * omega - beta3 / 6 * omega * omega * omega);
+	}
+
+	numberOfSteps = max(1, (int) ceil(length / stepLength));
+	double h = length / numberOfSteps;
+	stepResponse.resize(frameSize);
+	halfStepResponse.resize(frameSize);
+	for (int k = 0; k < frameSize; k++) {
+		stepResponse[k] = (t_complex) polar(exp(-alpha * h / 2) / frameSize, (double) dispersionPhase[k] * h);
+		halfStepResponse[k] = (t_complex) polar(exp(-alpha * h / 4) / frameSize, (double) dispersionPhase[k] * h / 2);
+	}
+
+	int threads = (numberOfThreads > 0) ? min(numberOfThreads, workerPool().size()) : workerPool().size();
+	batch.initialize(frameSize, guard, (framesPerBatch > 0) ? framesPerBatch : threads);
+	if (stepControl == LocalErrorStep) scratch.resize((size_t) 2 * batch.batchFrames * frameSize);
+	stepsTaken = 0;
+}
+
+bool FiberSpan::runBlock(void) {
+
+	if (firstTime) initialize();
+
+	bool alive = false;
+
+	// The pending samples are output first, then input is read until the batch is full, or until no more input comes with at least one
+	// whole frame read, and the frames read are propagated; once the input has ended, the last partial frame too, zero-padded.
+	while (true) {
+		if (batch.pending() > 0) {
+			if (batch.write(outputSignals[0]) > 0) alive = true;
+			if (batch.pending() > 0) break;
+		}
+
+		int read = batch.read(inputSignals[0]);
+		if (read > 0) alive = true;
+
+		int frames = batch.frames();
+		int samples = frames * batch.newSamples;
+		if (inputEnded && (read == 0) && (batch.filled() > samples)) {
+			frames = batch.padFrames();
+			samples = batch.filled();
+		}
+		if (frames == 0) break;
+		if (!batch.full() && (read > 0)) break;
+
+		propagate(frames, samples);
+	}
+
+	return alive;
+}
+
+void FiberSpan::propagate(int frames, int samples) {
+
+	int threads = (numberOfThreads > 0) ? min(numberOfThreads, workerPool().size()) : workerPool().size();
+	vector<int> steps(frames);
+
+	auto propagateFrame = [&](int f, int fftThreads) {
+		t_complex *x = batch.output(f);
+		copy(batch.input(f), batch.input(f) + frameSize, x);
+		if (stepControl == FixedStep) steps[f] = fixedSteps(x, fftThreads);
+		else if (stepControl == NonlinearPhaseStep) steps[f] = nonlinearPhaseSteps(x, fftThreads);
+		else steps[f] = localErrorSteps(x, scratch.data() + (size_t) 2 * f * frameSize, scratch.data() + (size_t)(2 * f + 1) * frameSize, fftThreads);
+	};
+
+	// Several frames are propagated one per thread, a single one with its FFTs split across the threads.
+	if (frames == 1) {
+		propagateFrame(0, threads);
+	}
+	else {
+		int tasks = min(frames, threads);
+		workerPool().run(tasks, [&](int t) {
+			for (int f = t; f < frames; f += tasks) propagateFrame(f, 1);
+		});
+	}
+	for (int f = 0; f < frames; f++) stepsTaken = stepsTaken + steps[f];
+
+	batch.advance(samples);
+}
+
+t_real FiberSpan::kerrScale(double h) {
+
+	// Kerr phase of a step, taken at mid step where the power is exp(alpha h/2) below its value at the step start.
+	return (t_real)((alpha > 0) ? gamma * 2 * sinh(alpha * h / 2) / alpha : gamma * h);
+}
+
+void FiberSpan::linearStep(t_complex *x, double distance) {
+
+	dspKernels().dispersionStep(x, dispersionPhase.data(), (t_real) distance, (t_real)(exp(-alpha * distance / 2) / frameSize), frameSize);
+}
+
+int FiberSpan::fixedSteps(t_complex *x, int threads) {
+
+	const DspKernels &kernels = dspKernels();
+	t_real scale = kerrScale(length / numberOfSteps);
+
+	// Half step, then (Kerr phase, step) numberOfSteps - 1 times, then Kerr phase and half step; the frame is in the frequency domain
+	// between the forward and the inverse FFT around each Kerr phase.
+	plan->forward(x, threads);
+	kernels.complexMultiply(x, halfStepResponse.data(), x, frameSize);
+	for (int step = 0; step < numberOfSteps; step++) {
+		plan->inverse(x, threads);
+		kernels.kerrPhase(x, scale, frameSize);
+		plan->forward(x, threads);
+		const t_complex *response = (step == numberOfSteps - 1) ? halfStepResponse.data() : stepResponse.data();
+		kernels.complexMultiply(x, response, x, frameSize);
+	}
+	plan->inverse(x, threads);
+
+	return numberOfSteps;
+}
+
+int FiberSpan::nonlinearPhaseSteps(t_complex *x, int threads) {
+
+	const DspKernels &kernels = dspKernels();
+
+	// Each step is sized on the peak power found by the Kerr phase of the previous one, the first on the peak power of the input; the
+	// linear half step left by a step is merged with the first half of the next one.
+	double peak = 0;
+	for (int k = 0; k < frameSize; k++) peak = max(peak, (double) norm(x[k]));
+
+	plan->forward(x, threads);
+	double z = 0;
+	double halfStepLeft = 0;
+	int steps = 0;
+	while (length - z > 1e-9 * length) {
+		double h = maximumStepLength;
+		if (gamma * peak * h > maximumNonlinearPhase) h = maximumNonlinearPhase / (gamma * peak);
+		h = min(h, length - z);
+
+		linearStep(x, halfStepLeft + h / 2);
+		plan->inverse(x, threads);
+		peak = kernels.kerrPhase(x, kerrScale(h), frameSize);
+		plan->forward(x, threads);
+
+		halfStepLeft = h / 2;
+		z = z + h;
+		steps++;
+	}
+	linearStep(x, halfStepLeft);
+	plan->inverse(x, threads);
+
+	return steps;
+}
+
+void FiberSpan::fullStep(t_complex *x, double h, int threads) {
+
+	plan->forward(x, threads);
+	linearStep(x, h / 2);
+	plan->inverse(x, threads);
+	dspKernels().kerrPhase(x, kerrScale(h), frameSize);
+	plan->forward(x, threads);
+	linearStep(x, h / 2);
+	plan->inverse(x, threads);
+}
+
+int FiberSpan::localErrorSteps(t_complex *x, t_complex *coarse, t_complex *fine, int threads) {
+
+	const double growth = pow(2.0, 1.0 / 3);
+
+	double z = 0;
+	double h = min(stepLength, maximumStepLength) / 2;		// fine step
+	int steps = 0;
+	while (length - z > 1e-9 * length) {
+		h = min(h, (length - z) / 2);
+
+		copy(x, x + frameSize, coarse);
+		fullStep(coarse, 2 * h, threads);
+		copy(x, x + frameSize, fine);
+		fullStep(fine, h, threads);
+		fullStep(fine, h, threads);
+		steps = steps + 3;
+
+		double difference = 0, energy = 0;
+		for (int k = 0; k < frameSize; k++) {
+			difference = difference + norm(fine[k] - coarse[k]);
+			energy = energy + norm(fine[k]);
+		}
+		double error = (energy > 0) ? sqrt(difference / energy) : 0;
+
+		// A step with twice the error goal is done again with half the length, unless it is already negligible.
+		if ((error > 2 * localError) && (h > 1e-6 * length)) {
+			h = h / 2;
+			continue;
+		}
+
+		for (int k = 0; k < frameSize; k++) x[k] = (t_real)(4.0 / 3) * fine[k] - (t_real)(1.0 / 3) * coarse[k];
+		z = z + 2 * h;
+
+		if (error > localError) h = h / growth;
+		else if (error < localError / 2) h = min(h * growth, maximumStepLength / 2);
+	}
+
+	return steps;
+}
@@ -0,0 +1,115 @@
+# include <math.h>		// floor, ldexp
+
+# include "netplus.h"
+# include "fixed_point.h"
+
+using namespace std;
+
+// Keeps a code inside the word, by saturation or by dropping the upper bits.
+static t_fixed overflowCode(long long code, const FixedPointFormat &format) {
+
+	if (format.overflow == Saturation) {
+		if (code > format.maxCode()) return (t_fixed)format.maxCode();
+		if (code < format.minCode()) return (t_fixed)format.minCode();
+		return (t_fixed)code;
+	}
+
+	int unusedBits = 64 - format.wordLength();
+	return (t_fixed)((long long)((unsigned long long)code << unusedBits) >> unusedBits);
+}
+
+t_fixed FixedPointFormat::quantize(t_real value) const {
+
+	double scaled = ldexp((double)value, fractionBits);
+	double code = floor(scaled);
+
+	switch (rounding) {
+		case RoundHalfUp:
+			code = floor(scaled + 0.5);
+			break;
+		case RoundHalfEven:
+			if ((scaled - code > 0.5) || ((scaled - code == 0.5) && (fmod(code, 2.0) != 0.0))) code = code + 1;
+			break;
+		default:
+			break;
+	}
+
+	// Codes far outside the word are clipped before the conversion to integer, they saturate (or wrap) the same way.
+	if (code > 1e18) code = 1e18;
+	if (code < -1e18) code = -1e18;
+
+	return overflowCode((long long)code, *this);
+}
+
+t_fixed FixedPointFormat::requantize(long long accumulator, int accumulatorFractionBits) const {
+
+	int shift = accumulatorFractionBits - fractionBits;
+
+	if (shift <= 0) return overflowCode(accumulator * (1LL << -shift), *this);
+
+	long long code = accumulator >> shift;				// arithmetic shift, rounds towards minus infinity
+	long long remainder = accumulator - (code << shift);
+	long long half = 1LL << (shift - 1);
+
+	switch (rounding) {
+		case RoundHalfUp:
+			if (remainder >= half) code++;
+			break;
+		case RoundHalfEven:
+			if ((remainder > half) || ((remainder == half) && (code & 1))) code++;
+			break;
+		default:
+			break;
+	}
+
+	return overflowCode(code, *this);
+}
+
+// The same rounding as requantize(), for a shift of at least 1: half up adds half before the shift, half even adds half - 1 and the
+// lowest bit of the truncated code, so that exact halves go to the even code.
+template<FixedPointRounding R, FixedPointOverflow O>
+static void requantizeCodes(const t_integer *accumulators, int shift, const FixedPointFormat &format, t_fixed *codes, int n) {
+
+	long long half = 1LL << (shift - 1);
+	long long maxCode = format.maxCode();
+	long long minCode = format.minCode();
+	int unusedBits = 64 - format.wordLength();
+
+	for (int i = 0; i < n; i++) {
+		long long accumulator = accumulators[i];
+		long long code = accumulator >> shift;
+		if (R == RoundHalfUp) code = (accumulator + half) >> shift;
+		if (R == RoundHalfEven) code = (accumulator + half - 1 + (code & 1)) >> shift;
+
+		if (O == Saturation) codes[i] = (t_fixed)((code > maxCode) ? maxCode : ((code < minCode) ? minCode : code));
+		else codes[i] = (t_fixed)((long long)((unsigned long long)code << unusedBits) >> unusedBits);
+	}
+}
+
+template<FixedPointRounding R>
+static void requantizeCodes(const t_integer *accumulators, int shift, const FixedPointFormat &format, t_fixed *codes, int n) {
+	if (format.overflow == Saturation) requantizeCodes<R, Saturation>(accumulators, shift, format, codes, n);
+	else requantizeCodes<R, WrapAround>(accumulators, shift, format, codes, n);
+}
+
+void FixedPointFormat::requantize(const t_integer *accumulators, int accumulatorFractionBits, t_fixed *codes, int n) const {
+
+	// The rounding and the overflow are selected once, out of the loop.
+	int shift = accumulatorFractionBits - fractionBits;
+	if (shift <= 0) {
+		for (int i = 0; i < n; i++) codes[i] = requantize(accumulators[i], accumulatorFractionBits);
+		return;
+	}
+
+	switch (rounding) {
+		case RoundHalfUp:
+			requantizeCodes<RoundHalfUp>(accumulators, shift, *this, codes, n);
+			break;
+		case RoundHalfEven:
+			requantizeCodes<RoundHalfEven>(accumulators, shift, *this, codes, n);
+			break;
+		default:
+			requantizeCodes<Truncation>(accumulators, shift, *this, codes, n);
+			break;
+	}
+}
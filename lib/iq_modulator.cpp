@@ -2,6 +2,7 @@
 
 # include "netplus.h"
 # include "iq_modulator.h"
+# include "dsp_kernels.h"
 
 
 using namespace std;
@@ -56,31 +57,192 @@ bool IqModulator::runBlock(void) {
 	}
 	*/
 
+	t_real amplitude = (t_real)(.5*sqrt(outputOpticalPower));
+
+	Signal *out = outputSignals[0];
+	const DspKernels &kernels = dspKernels();
+
+	if (transfer == MachZehnderModulator) {
+
+		int process = out->space();
+		for (int k = 0; k < numberOfInputSignals; k++) process = min(process, inputSignals[k]->ready());
+
+		if (process == 0) return false;
+
+		putMachZehnder(process);
+		return true;
+	}
+
+	if (numberOfInputSignals == 1) {
+
+		Signal *in = inputSignals[0];
+
+		int ready = in->ready();
+		int space = out->space();
+
+		int process = min(ready, space);
+
+		if (process == 0) return false;
+
+		// With the same layout on both sides the drive signal is scaled directly between the buffers, in contiguous runs.
+		if (in->getComplexLayout() == out->getComplexLayout()) {
+			while (process > 0) {
+				int n = min(process, min(in->contiguousReady(), out->contiguousSpace()));
+				if (n <= 0) break;
+
+				if (out->getComplexLayout() == SplitPlanes) {
+					kernels.realScale(in->realPlane() + in->outPosition, amplitude, out->realPlane() + out->inPosition, n);
+					kernels.realScale(in->imagPlane() + in->outPosition, amplitude, out->imagPlane() + out->inPosition, n);
+				}
+				else {
+					kernels.complexScale(static_cast<t_complex *>(in->buffer) + in->outPosition, amplitude, static_cast<t_complex *>(out->buffer) + out->inPosition, n);
+				}
+
+				in->commitGet(n);
+				out->commitPut(n);
+				process = process - n;
+			}
+			return true;
+		}
+
+		t_complex iq;
+		for (int i = 0; i < process; i++) {
+
+			in->bufferGet(&iq);
+
+			out->bufferPut((t_complex)(amplitude*iq));
+		}
+
+		return true;
+	}
+
 	int ready0 = inputSignals[0]->ready();
 	int ready1 = inputSignals[1]->ready();
 	int ready = min(ready0, ready1);
 
-	int space = outputSignals[0]->space();
+	int space = out->space();
 
 	int process = min(ready, space);
 
 	if (process == 0) return false;
 
-	t_real re, im;
-	for (int i = 0; i < process; i++) {
+	// Fixed-point drive signals (DAC codes) are converted with the format of each signal.
+	if (inputSignals[0]->getValueType() == FixedPointValue) {
+
+		t_real iScale = (t_real)ldexp(1.0, -inputSignals[0]->getFractionBits());
+		t_real qScale = (t_real)ldexp(1.0, -inputSignals[1]->getFractionBits());
+
+		t_fixed iCode, qCode;
+		for (int i = 0; i < process; i++) {
 
-		inputSignals[0]->bufferGet(&re);
-		inputSignals[1]->bufferGet(&im);
+			inputSignals[0]->bufferGet(&iCode);
+			inputSignals[1]->bufferGet(&qCode);
 
-		complex<t_real> myComplex( re, im);
+			complex<t_real> myComplex(iScale * iCode, qScale * qCode);
 
-		myComplex = .5*sqrt(outputOpticalPower)*myComplex;
+			out->bufferPut((t_complex)(amplitude*myComplex));
+		}
 
-		outputSignals[0]->bufferPut(myComplex);
+		return true;
+	}
+
+	// Real drive signals are combined in contiguous runs of the buffers: straight into the planes of a SplitPlanes output,
+	// or interleaved and then scaled.
+	while (process > 0) {
+		int n = min(process, min(min(inputSignals[0]->contiguousReady(), inputSignals[1]->contiguousReady()), out->contiguousSpace()));
+		if (n <= 0) break;
+
+		const t_real *re = static_cast<t_real *>(inputSignals[0]->buffer) + inputSignals[0]->outPosition;
+		const t_real *im = static_cast<t_real *>(inputSignals[1]->buffer) + inputSignals[1]->outPosition;
+
+		if (out->getComplexLayout() == SplitPlanes) {
+			kernels.realScale(re, amplitude, out->realPlane() + out->inPosition, n);
+			kernels.realScale(im, amplitude, out->imagPlane() + out->inPosition, n);
+		}
+		else {
+			t_complex *iq = static_cast<t_complex *>(out->buffer) + out->inPosition;
+			kernels.interleave(re, im, iq, n);
+			kernels.complexScale(iq, amplitude, iq, n);
+		}
+
+		inputSignals[0]->commitGet(n);
+		inputSignals[1]->commitGet(n);
+		out->commitPut(n);
+		process = process - n;
 	}
 
 	return true;
 }
+
+void IqModulator::putMachZehnder(int process) {
+
+	Signal *out = outputSignals[0];
+	const DspKernels &kernels = dspKernels();
+
+	t_real amplitude = (t_real)(.5*sqrt(outputOpticalPower));
+	t_real phaseScale = (t_real)(PI / 2 / vPi);
+	t_real phaseI = (t_real)(PI / 2 * biasI / vPi);
+	t_real phaseQ = (t_real)(PI / 2 * biasQ / vPi);
+	t_real leakage = (t_real)pow(10, -extinctionRatio_dB / 20);
+
+	// The drive voltages are read in place from real and SplitPlanes inputs, otherwise deinterleaved or converted from the DAC codes first;
+	// the field is written in place in a SplitPlanes output, otherwise in planes that are then interleaved.
+	while (process > 0) {
+		int n = min(process, out->contiguousSpace());
+		for (int k = 0; k < numberOfInputSignals; k++) n = min(n, inputSignals[k]->contiguousReady());
+		if (n <= 0) break;
+
+		const t_real *vI;
+		const t_real *vQ;
+		if (numberOfInputSignals == 1) {
+			Signal *in = inputSignals[0];
+			if (in->getComplexLayout() == SplitPlanes) {
+				vI = in->realPlane() + in->outPosition;
+				vQ = in->imagPlane() + in->outPosition;
+			}
+			else {
+				driveI.resize(n);
+				driveQ.resize(n);
+				kernels.deinterleave(static_cast<t_complex *>(in->buffer) + in->outPosition, driveI.data(), driveQ.data(), n);
+				vI = driveI.data();
+				vQ = driveQ.data();
+			}
+		}
+		else if (inputSignals[0]->getValueType() == FixedPointValue) {
+			t_real iScale = (t_real)ldexp(1.0, -inputSignals[0]->getFractionBits());
+			t_real qScale = (t_real)ldexp(1.0, -inputSignals[1]->getFractionBits());
+			const t_fixed *iCodes = static_cast<t_fixed *>(inputSignals[0]->buffer) + inputSignals[0]->outPosition;
+			const t_fixed *qCodes = static_cast<t_fixed *>(inputSignals[1]->buffer) + inputSignals[1]->outPosition;
+			driveI.resize(n);
+			driveQ.resize(n);
+			for (int k = 0; k < n; k++) {
+				driveI[k] = iScale * iCodes[k];
+				driveQ[k] = qScale * qCodes[k];
+			}
+			vI = driveI.data();
+			vQ = driveQ.data();
+		}
+		else {
+			vI = static_cast<t_real *>(inputSignals[0]->buffer) + inputSignals[0]->outPosition;
+			vQ = static_cast<t_real *>(inputSignals[1]->buffer) + inputSignals[1]->outPosition;
+		}
+
+		if (out->getComplexLayout() == SplitPlanes) {
+			kernels.iqMachZehnder(vI, vQ, phaseScale, phaseI, phaseQ, leakage, amplitude, out->realPlane() + out->inPosition, out->imagPlane() + out->inPosition, n);
+		}
+		else {
+			fieldRe.resize(n);
+			fieldIm.resize(n);
+			kernels.iqMachZehnder(vI, vQ, phaseScale, phaseI, phaseQ, leakage, amplitude, fieldRe.data(), fieldIm.data(), n);
+			kernels.interleave(fieldRe.data(), fieldIm.data(), static_cast<t_complex *>(out->buffer) + out->inPosition, n);
+		}
+
+		for (int k = 0; k < numberOfInputSignals; k++) inputSignals[k]->commitGet(n);
+		out->commitPut(n);
+		process = process - n;
+	}
+}
+
 //
 //ComplexToReal::ComplexToReal(vector<Signal *> &InputSig, vector<Signal *> &OutputSig) {
 //
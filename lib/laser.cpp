@@ -1,28 +1,107 @@
+
+# include <algorithm>	// std::min, std::max
+
 # include "netplus.h"
 # include "laser.h"
+# include "dsp_kernels.h"
 
 using namespace std;
 
-Laser::Laser(vector<Signal*> &InputSig, vector<Signal*> &OutputSig) {
+Laser::Laser(vector<Signal*> &InputSig, vector<Signal*> &OutputSig) :Block(InputSig, OutputSig) {
+
+	generator.setStream(newDefaultStream());
+}
+
+void Laser::initialize(void) {
 
-  numberOfInputSignals = InputSig.size();
-  numberOfOutputSignals = OutputSig.size();
+	firstTime = false;
 
-  inputSignals = InputSig;
-  outputSignals = OutputSig;
+	outputSignals[0]->setSamplingPeriod(samplingPeriod);
+	outputSignals[0]->setSymbolPeriod(samplingPeriod);
+	outputSignals[0]->setCentralWavelength(centralWavelength);
 
-  outputSignals[0]->setSamplingPeriod(samplingPeriod);
-  outputSignals[0]->setCentralWavelength(centralWavelength)
+	generator.setSeed((seed == -1) ? getRunSeed() : (uint64_t) seed);
+	if (streamId >= 0) generator.setStream((uint64_t) streamId);
 
+	sampleIndex = 0;
+	phase = initialPhase;
 }
 
 bool Laser::runBlock(void) {
 
+	if (firstTime) initialize();
+
 	int space = outputSignals[0]->space();
 
-	if (space == 0) return false;
+	int process;
+	if (numberOfSamples >= 0) {
+		process = (int) min((long long) space, numberOfSamples);
+	}
+	else {
+		process = space;
+	}
+
+	if (process <= 0) return false;
 
-	for (int k = 0; k < space; k++) outputSignals[0]->bufferPut(polar(1,initialPhase));
+	putSamples(process);
+	if (numberOfSamples >= 0) numberOfSamples = numberOfSamples - process;
 
 	return true;
 }
+
+void Laser::putSamples(int process) {
+
+	Signal *out = outputSignals[0];
+	const DspKernels &kernels = dspKernels();
+
+	double phaseDeviation = sqrt(2 * PI * linewidth * samplingPeriod);
+	double intensityDeviation = sqrt(pow(10, rin_dB_Hz / 10) / (2 * samplingPeriod));
+	bool noisy = (phaseDeviation > 0) || (intensityDeviation > 0);
+
+	// The field is computed in contiguous runs of the buffer: straight into the planes of a SplitPlanes output, otherwise in planes
+	// that are then interleaved.
+	while (process > 0) {
+		int n = min(process, out->contiguousSpace());
+		if (n <= 0) break;
+
+		if ((int) phases.size() < n) {
+			gaussians.resize(2 * n);
+			magnitudes.resize(n);
+			phases.resize(n);
+			fieldRe.resize(n);
+			fieldIm.resize(n);
+		}
+
+		if (noisy) {
+			generator.gaussian(2 * sampleIndex, gaussians.data(), 2 * n);
+
+			// The phase is accumulated sample by sample and wrapped at each crossing of +-pi, so that it does not depend on where
+			// the runs start.
+			for (int k = 0; k < n; k++) {
+				phases[k] = (t_real) phase;
+				phase = phase + phaseDeviation * gaussians[2 * k];
+				if (phase > PI) phase = phase - 2 * PI;
+				else if (phase < -PI) phase = phase + 2 * PI;
+			}
+			for (int k = 0; k < n; k++) {
+				magnitudes[k] = (t_real) sqrt(outputOpticalPower * max(0.0, 1.0 + intensityDeviation * gaussians[2 * k + 1]));
+			}
+		}
+		else {
+			fill(phases.begin(), phases.begin() + n, (t_real) phase);
+			fill(magnitudes.begin(), magnitudes.begin() + n, (t_real) sqrt(outputOpticalPower));
+		}
+
+		if (out->getComplexLayout() == SplitPlanes) {
+			kernels.polar(magnitudes.data(), phases.data(), out->realPlane() + out->inPosition, out->imagPlane() + out->inPosition, n);
+		}
+		else {
+			kernels.polar(magnitudes.data(), phases.data(), fieldRe.data(), fieldIm.data(), n);
+			kernels.interleave(fieldRe.data(), fieldIm.data(), static_cast<t_complex *>(out->buffer) + out->inPosition, n);
+		}
+
+		out->commitPut(n);
+		sampleIndex = sampleIndex + n;
+		process = process - n;
+	}
+}
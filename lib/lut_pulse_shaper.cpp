@@ -0,0 +1,148 @@
+# include <algorithm>	// sort, unique
+
+# include "netplus.h"
+# include "lut_pulse_shaper.h"
+# include "dsp_kernels.h"
+
+using namespace std;
+
+const int MAX_LUT_GROUP_SIZE = 65536;	// Maximum number of entries of the table of one group
+
+void LutPulseShaper::setAlphabet(vector<t_real> symbolAlphabet) {
+	sort(symbolAlphabet.begin(), symbolAlphabet.end());
+	symbolAlphabet.erase(unique(symbolAlphabet.begin(), symbolAlphabet.end()), symbolAlphabet.end());
+	alphabet = symbolAlphabet;
+};
+
+void LutPulseShaper::initialize(void) {
+
+	PolyphasePulseShaper::initialize();
+
+	lookUpTable.clear();
+
+	// Complex and fixed-point symbols are shaped by the PolyphasePulseShaper paths.
+	int alphabetSize = alphabet.size();
+	if ((alphabetSize == 0) || (inputSignals[0]->getValueType() != RealValue)) return;
+
+	int sps = getNumberOfSamplesPerSymbol();
+
+	// Largest group for which the tables of all branches fit in lookUpTableMaxSize.
+	symbolsPerGroup = 1;
+	for (int k = 2; k <= numberOfTapsPerPhase; k++) {
+		long int entries = 1;
+		for (int j = 0; (j < k) && (entries <= MAX_LUT_GROUP_SIZE); j++) entries = entries * alphabetSize;
+		if (entries > MAX_LUT_GROUP_SIZE) break;
+
+		int groups = (numberOfTapsPerPhase + k - 1) / k;
+		double size = (double)sps * groups * entries * sizeof(t_real);
+		if (size > lookUpTableMaxSize) break;
+
+		symbolsPerGroup = k;
+	}
+
+	numberOfGroups = (numberOfTapsPerPhase + symbolsPerGroup - 1) / symbolsPerGroup;
+	symbolsPerWindow = numberOfGroups * symbolsPerGroup;
+	groupTableSize = 1;
+	for (int j = 0; j < symbolsPerGroup; j++) groupTableSize = groupTableSize * alphabetSize;
+
+	int padding = symbolsPerWindow - numberOfTapsPerPhase;
+	windowTaps.assign(sps * symbolsPerWindow, 0.0);
+	for (int p = 0; p < sps; p++)
+		for (int m = 0; m < numberOfTapsPerPhase; m++)
+			windowTaps[p * symbolsPerWindow + padding + m] = polyphaseTaps[p * numberOfTapsPerPhase + m];
+
+	// Entry idx of a group holds the symbols idx = d0 + d1*A + d2*A^2 + ..., with d0 the oldest one.
+	lookUpTable.assign(sps * numberOfGroups * groupTableSize, 0.0);
+	for (int p = 0; p < sps; p++) {
+		for (int g = 0; g < numberOfGroups; g++) {
+			const t_real *taps = &windowTaps[p * symbolsPerWindow + g * symbolsPerGroup];
+			t_real *table = &lookUpTable[(p * numberOfGroups + g) * groupTableSize];
+			for (int idx = 0; idx < groupTableSize; idx++) {
+				int aux = idx;
+				t_real value{ 0.0 };
+				for (int j = 0; j < symbolsPerGroup; j++) {
+					value += alphabet[aux % alphabetSize] * taps[j];
+					aux = aux / alphabetSize;
+				}
+				table[idx] = value;
+			}
+		}
+	}
+
+	// The filter starts with a window of zeros.
+	int zeroIndex = -1;
+	for (int i = 0; i < alphabetSize; i++) if (alphabet[i] == 0.0) zeroIndex = i;
+
+	valueHistory.assign(2 * symbolsPerWindow, 0.0);
+	indexHistory.assign(2 * symbolsPerWindow, zeroIndex);
+	unknownSymbols = (zeroIndex < 0) ? symbolsPerWindow : 0;
+	groupIndex.assign(numberOfGroups, 0);
+	historyPosition = 0;
+	phase = 0;
+
+}
+
+bool LutPulseShaper::runBlock(void) {
+
+	if (lookUpTable.empty()) return PolyphasePulseShaper::runBlock();
+
+	int ready = inputSignals[0]->ready();
+	int space = outputSignals[0]->space();
+
+	int sps = getNumberOfSamplesPerSymbol();
+	int alphabetSize = alphabet.size();
+
+	bool alive{ false };
+
+	while (space > 0) {
+
+		if (phase == 0) {
+			if (ready == 0) break;
+
+			t_real value;
+			inputSignals[0]->bufferGet(&value);
+			ready--;
+
+			int index = -1;
+			for (int i = 0; i < alphabetSize; i++) if (alphabet[i] == value) { index = i; break; }
+
+			if (indexHistory[historyPosition] < 0) unknownSymbols--;
+			if (index < 0) unknownSymbols++;
+
+			valueHistory[historyPosition] = value;
+			valueHistory[historyPosition + symbolsPerWindow] = value;
+			indexHistory[historyPosition] = index;
+			indexHistory[historyPosition + symbolsPerWindow] = index;
+			historyPosition++;
+			if (historyPosition == symbolsPerWindow) historyPosition = 0;
+
+			if (unknownSymbols == 0) {
+				for (int g = 0; g < numberOfGroups; g++) {
+					const int *window = &indexHistory[historyPosition + g * symbolsPerGroup];
+					int aux = 0;
+					for (int j = symbolsPerGroup - 1; j >= 0; j--) aux = aux * alphabetSize + window[j];
+					groupIndex[g] = aux;
+				}
+			}
+		}
+
+		t_real value{ 0.0 };
+		if (unknownSymbols == 0) {
+			const t_real *table = &lookUpTable[phase * numberOfGroups * groupTableSize];
+			for (int g = 0; g < numberOfGroups; g++) value += table[g * groupTableSize + groupIndex[g]];
+		}
+		else {
+			const t_real *taps = &windowTaps[phase * symbolsPerWindow];
+			value = dspKernels().dotProduct(&valueHistory[historyPosition], taps, symbolsPerWindow);
+		}
+
+		outputSignals[0]->bufferPut(value);
+		space--;
+		alive = true;
+
+		phase++;
+		if (phase == sps) phase = 0;
+	}
+
+	return alive;
+};
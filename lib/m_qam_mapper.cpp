@@ -37,64 +37,201 @@ MQamMapper::MQamMapper(vector<Signal *> &InputSig, vector<Signal *> &OutputSig):
 	
 }*/
 
+static int grayToBinary(int g) {
+	int b = g;
+	for (int shift = 1; (g >> shift) > 0; shift++) b ^= g >> shift;
+	return b;
+}
+
+vector<t_iqValues> grayQamConstellation(int m) {
+
+	int n = 0;
+	while ((1 << n) < m) n++;
+	if (m < 2 || m > MAX_M_QAM || (1 << n) != m) return {};
+
+	int iBits = (n + 1) / 2;
+	int qBits = n / 2;
+	int iLevels = 1 << iBits;
+	int qLevels = 1 << qBits;
+
+	// Cross constellations: the columns beyond the side of the cross, |I| > 3 * 2^(qBits-1) - 1, are folded to |Q| > qLevels - 1.
+	bool cross = (n % 2 == 1) && (n >= 5);
+	int crossEdge = cross ? 3 * (1 << (qBits - 1)) - 1 : iLevels;
+
+	vector<t_iqValues> constellation(m);
+	double power{ 0.0 };
+	for (int label = 0; label < m; label++) {
+		int I = 2 * grayToBinary(label >> qBits) - (iLevels - 1);
+		int Q = 2 * grayToBinary(label & (qLevels - 1)) - (qLevels - 1);
+		if (abs(I) > crossEdge) {
+			int folded = (I > 0 ? 1 : -1) * (qLevels - abs(Q));
+			Q = (Q > 0 ? 1 : -1) * (abs(I) - qLevels / 2);
+			I = folded;
+		}
+		constellation[label] = { (t_real) I, (t_real) Q };
+		power += (double) I * I + (double) Q * Q;
+	}
+
+	t_real scale = (t_real)(1.0 / sqrt(power / m));
+	for (auto &point : constellation) {
+		point.i = point.i * scale;
+		point.q = point.q * scale;
+	}
+
+	return constellation;
+}
+
 void MQamMapper::initialize(void){
 
-	outputSignals[0]->symbolPeriod = 2 * inputSignals[0]->symbolPeriod;
-	outputSignals[0]->samplingPeriod = 2 * inputSignals[0]->samplingPeriod;
+	if ((int) iqAmplitudes.size() != m) setM(m);
+
+	bitsPerSymbol = 0;
+	while ((1 << bitsPerSymbol) < m) bitsPerSymbol++;
+
+	outputSignals[0]->symbolPeriod = bitsPerSymbol * inputSignals[0]->symbolPeriod;
+	outputSignals[0]->samplingPeriod = bitsPerSymbol * inputSignals[0]->samplingPeriod;
 	outputSignals[0]->samplesPerSymbol = 1;
 	outputSignals[0]->setFirstValueToBeSaved(inputSignals[0]->getFirstValueToBeSaved());
 
-	outputSignals[1]->symbolPeriod = 2 * inputSignals[0]->symbolPeriod;
-	outputSignals[1]->samplingPeriod = 2 * inputSignals[0]->samplingPeriod;
-	outputSignals[1]->samplesPerSymbol = 1;
-	outputSignals[1]->setFirstValueToBeSaved(inputSignals[0]->getFirstValueToBeSaved());
+	if (numberOfOutputSignals > 1) {
+		outputSignals[1]->symbolPeriod = bitsPerSymbol * inputSignals[0]->symbolPeriod;
+		outputSignals[1]->samplingPeriod = bitsPerSymbol * inputSignals[0]->samplingPeriod;
+		outputSignals[1]->samplesPerSymbol = 1;
+		outputSignals[1]->setFirstValueToBeSaved(inputSignals[0]->getFirstValueToBeSaved());
+	}
 
-	setM(m);
+	complexOutput = (outputSignals[0]->getValueType() == ComplexValue);
+	fixedPointOutput = (outputSignals[0]->getValueType() == FixedPointValue);
+	if (fixedPointOutput)
+		for (unsigned int i = 0; i < outputSignals.size(); i++) outputFixedPointFormat.setFormatOf(outputSignals[i]);
+
+	// The kernels are used only when iqAmplitudes is the Gray constellation, whether set by setM or not. The amplitudes of a square
+	// constellation are (2p - (L-1)) / sqrt(2 (m-1) / 3), computed as in grayQamConstellation.
+	mapperKernel = nullptr;
+	complexMapperKernel = nullptr;
+	bool grayConstellation = (getQamMapperKernel(bitsPerSymbol) != nullptr) && !fixedPointOutput;
+	if (grayConstellation) {
+		vector<t_iqValues> gray = grayQamConstellation(m);
+		for (int k = 0; k < m; k++)
+			if ((iqAmplitudes[k].i != gray[k].i) || (iqAmplitudes[k].q != gray[k].q)) grayConstellation = false;
+	}
+	if (grayConstellation) {
+		grayScale = (t_real)(1.0 / sqrt(2.0 * (m - 1) / 3.0));
+		mapperKernel = getQamMapperKernel(bitsPerSymbol);
+		complexMapperKernel = getComplexQamMapperKernel(bitsPerSymbol);
+	}
+
+	complexTable.resize(m);
+	fixedTable.resize(2 * m);
+	for (int k = 0; k < m; k++) {
+		complexTable[k] = t_complex(iqAmplitudes[k].i, iqAmplitudes[k].q);
+		if (fixedPointOutput) {
+			fixedTable[2 * k] = outputFixedPointFormat.quantize(iqAmplitudes[k].i);
+			fixedTable[2 * k + 1] = outputFixedPointFormat.quantize(iqAmplitudes[k].q);
+		}
+	}
+}
+
+void MQamMapper::putBit(t_binary bit) {
+
+	auxSignalNumber = (auxSignalNumber << 1) | (t_integer)(bit & 1);
+	auxBinaryValue++;
+	if (auxBinaryValue < bitsPerSymbol) return;
+
+	if (complexOutput) {
+		outputSignals[0]->bufferPut(complexTable[auxSignalNumber]);
+	}
+	else if (fixedPointOutput) {
+		outputSignals[0]->bufferPut(fixedTable[2 * auxSignalNumber]);
+		outputSignals[1]->bufferPut(fixedTable[2 * auxSignalNumber + 1]);
+	}
+	else {
+		outputSignals[0]->bufferPut(iqAmplitudes[auxSignalNumber].i);
+		outputSignals[1]->bufferPut(iqAmplitudes[auxSignalNumber].q);
+	}
+	auxBinaryValue = 0;
+	auxSignalNumber = 0;
+}
+
+int MQamMapper::symbolSpace(void) {
+
+	int space = outputSignals[0]->contiguousSpace();
+	if (!complexOutput) space = min(space, outputSignals[1]->contiguousSpace());
+	return space;
 }
 
 bool MQamMapper::runBlock(void) {
 
+	Signal *in = inputSignals[0];
+
+	int ready = in->ready();
 
-	int ready = inputSignals[0]->ready();
-	int space1 = outputSignals[0]->space();
-	int space2 = outputSignals[1]->space();
+	int space = outputSignals[0]->space();
+	if (!complexOutput) space = min(space, outputSignals[1]->space());
 
-	int space = (space1 <= space2) ? space1 : space2;
-	int length = (ready <= (2 * space)) ? ready : space; // equivalent to min(ready, 2 * space);
+	// The bits of at most space symbols, counting those of the current symbol already read.
+	int length = min(ready, bitsPerSymbol * space - auxBinaryValue);
 
 	if (length <= 0) return false;
 
-	int binaryValue;
-	int nBinaryValues = (int)log2(m);
-	for (int i = 0; i < length; i++) {
-		inputSignals[0]->bufferGet(&binaryValue);
-		auxSignalNumber = auxSignalNumber + (int) pow(2, nBinaryValues - 1 - auxBinaryValue) * binaryValue;
-		auxBinaryValue++;
-		if (auxBinaryValue == nBinaryValues) {
-			t_real auxI = iqAmplitudes[auxSignalNumber].i;
-			t_real auxQ = iqAmplitudes[auxSignalNumber].q;
-			outputSignals[0]->bufferPut((t_real)auxI);
-			outputSignals[1]->bufferPut((t_real)auxQ);
-			auxBinaryValue = 0;
-			auxSignalNumber = 0;
+	// Whole symbols of a contiguous run of bits are mapped by the kernels straight into the output buffers. The bits of a symbol split
+	// by the end of a run or of an output buffer are shifted one by one into the symbol index, and a complete index is looked up in the tables.
+	while (length > 0) {
+		int n = min(length, in->contiguousReady());
+		const t_binary *bits = static_cast<t_binary *>(in->buffer) + in->outPosition;
+		int k = 0;
+		while (k < n) {
+			if (mapperKernel != nullptr && auxBinaryValue == 0) {
+				int symbols = min((n - k) / bitsPerSymbol, symbolSpace());
+				if (symbols > 0) {
+					Signal *outI = outputSignals[0];
+					if (!complexOutput) {
+						Signal *outQ = outputSignals[1];
+						mapperKernel(bits + k, grayScale, static_cast<t_real *>(outI->buffer) + outI->inPosition, static_cast<t_real *>(outQ->buffer) + outQ->inPosition, symbols);
+						outQ->commitPut(symbols);
+					}
+					else if (outI->getComplexLayout() == SplitPlanes) {
+						mapperKernel(bits + k, grayScale, outI->realPlane() + outI->inPosition, outI->imagPlane() + outI->inPosition, symbols);
+					}
+					else {
+						complexMapperKernel(bits + k, grayScale, static_cast<t_complex *>(outI->buffer) + outI->inPosition, symbols);
+					}
+					outI->commitPut(symbols);
+					k = k + bitsPerSymbol * symbols;
+					continue;
+				}
+			}
+			putBit(bits[k]);
+			k++;
 		}
+		in->commitGet(n);
+		length = length - n;
 	}
 
 	return true;
 }
 
 void MQamMapper::setIqAmplitudes(vector<t_iqValues> iqAmplitudesValues){
-	m = iqAmplitudesValues.size();
-	iqAmplitudes.resize(m);
+
+	// Each symbol reads log2(m) bits, so the constellation must have 2^n points, n >= 1.
+	int size = (int)iqAmplitudesValues.size();
+	if (size < 2 || (size & (size - 1)) != 0) {
+		cerr << "MQamMapper: a constellation of " << size << " points is not a power of 2 of at least 2 points, it is ignored" << endl;
+		return;
+	}
+
+	m = size;
 	iqAmplitudes = iqAmplitudesValues; 
 };
 
 void MQamMapper::setM(int mValue){
-	m = mValue;
 
-	iqAmplitudes.resize(m);
-	switch (m) {
-	case 4:
-		iqAmplitudes = { { 1.0, 1.0 }, { -1.0, 1.0 }, { -1.0, -1.0 }, { 1.0, -1.0 } };
-	};
-};
\ No newline at end of file
+	vector<t_iqValues> constellation = grayQamConstellation(mValue);
+	if (constellation.empty()) {
+		cerr << "MQamMapper: m = " << mValue << " is not a power of 2 between 2 and " << MAX_M_QAM << ", it is ignored" << endl;
+		return;
+	}
+
+	m = mValue;
+	iqAmplitudes = constellation;
+};
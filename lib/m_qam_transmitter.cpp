@@ -1,6 +1,36 @@
 # include "m_qam_transmitter.h"
 
 
+void MQamTransmitter::initialize(void) {
+
+	// The pulse shapers tables are built from the I and Q levels of the constellation
+	vector<t_real> iLevels, qLevels;
+	for (unsigned int i = 0; i < B2.iqAmplitudes.size(); i++) {
+		iLevels.push_back(B2.iqAmplitudes[i].i);
+		qLevels.push_back(B2.iqAmplitudes[i].q);
+	}
+	B3.setAlphabet(iLevels);
+	B4.setAlphabet(qLevels);
+
+	SuperBlock::initialize();
+}
+
+void MQamTransmitter::setIqPulseShaping(IqPulseShaping iqShaping) {
+
+	iqPulseShaping = iqShaping;
+
+	switch (iqPulseShaping) {
+		case JointIq:
+			setModuleBlocks({ &B1, &B6, &B7, &B8 });
+			break;
+		case SeparateIq:
+			setModuleBlocks({ &B1, &B2, &B3, &B4, &B5 });
+			break;
+	};
+
+	setSaveInternalSignals(getSaveInternalSignals());
+}
+
 void MQamTransmitter::set(int opt) {
 
 	// Basic Configuration
@@ -9,6 +9,7 @@
 
 
 # include "netplus.h"
+# include "dsp_kernels.h"
 
 
 using namespace std;
@@ -20,26 +21,60 @@ using namespace std;
 void Signal::close() {
 
 	if (saveSignal && (inPosition >= firstValueToBeSaved)) {
-		char *ptr = (char *)buffer;
-
 
 		ofstream fileHandler;
 		fileHandler.open("./signals/" + fileName, ios::out | ios::binary | ios::app);
 		
-		if (type == "Binary") {
-			ptr = ptr + (firstValueToBeSaved - 1)*sizeof(t_binary);
-			fileHandler.write((char *)ptr, (inPosition - (firstValueToBeSaved - 1))*sizeof(t_binary));
-		}
-		else if (type == "TimeContinuousAmplitudeContinuousComplex") {
-			ptr = ptr + (firstValueToBeSaved - 1)*sizeof(t_complex);
-			fileHandler.write((char *)ptr, (inPosition - (firstValueToBeSaved - 1))*sizeof(t_complex));
-		}
-		else {
-			ptr = ptr + (firstValueToBeSaved - 1)*sizeof(t_real);
-			fileHandler.write((char *)ptr, (inPosition - (firstValueToBeSaved - 1))*sizeof(t_real));
-		}
+		writeValues(fileHandler, firstValueToBeSaved - 1, inPosition);
+
+		fileHandler.close();
+	}
+};
+
+void Signal::saveBuffer() {
 
+	if (firstValueToBeSaved <= bufferLength) {
+		ofstream fileHandler("./" + folderName + "/" + fileName, ios::out | ios::binary | ios::app);
+		writeValues(fileHandler, firstValueToBeSaved - 1, bufferLength);
 		fileHandler.close();
+		firstValueToBeSaved = 1;
+	}
+	else {
+		firstValueToBeSaved = firstValueToBeSaved - bufferLength;
+	}
+};
+
+void Signal::writeValues(ofstream &fileHandler, int first, int last) {
+
+	if (last <= first) return;
+
+	if ((valueType == ComplexValue) && (complexLayout == SplitPlanes)) {
+		vector<t_complex> aux(last - first);
+		dspKernels().interleave(realPlane() + first, imagPlane() + first, aux.data(), last - first);
+		fileHandler.write((char *)aux.data(), (last - first)*sizeof(t_complex));
+		return;
+	}
+
+	char *ptr = (char *)buffer;
+	ptr = ptr + first*valueSize();
+	fileHandler.write(ptr, (last - first)*valueSize());
+};
+
+int Signal::valueSize() {
+
+	switch (valueType) {
+		case BinaryValue:
+			return sizeof(t_binary);
+		case IntegerValue:
+			return sizeof(t_integer);
+		case ComplexValue:
+			return sizeof(t_complex);
+		case ComplexXYValue:
+			return sizeof(t_complex_xy);
+		case FixedPointValue:
+			return sizeof(t_fixed);
+		default:
+			return sizeof(t_real);
 	}
 };
 
@@ -71,7 +106,7 @@ int Signal::ready() {
 			return (inPosition - outPosition);
 		}
 		else {
-			return (bufferLength - outPosition + inPosition + 1);
+			return (bufferLength - outPosition + inPosition);
 		}
 
 	}
@@ -88,6 +123,13 @@ void Signal::writeHeader(){
 		headerFile << "Signal type: " << type << "\n";
 		headerFile << "Symbol Period (s): " << symbolPeriod << "\n";
 		headerFile << "Sampling Period (s): " << samplingPeriod << "\n";
+		if (valueType == FixedPointValue) {
+			headerFile << "Precision: int16\n";
+			headerFile << "Fixed-point format: Q" << integerBits << "." << fractionBits << "\n";
+		}
+		else {
+			headerFile << "Precision: " << REAL_PRECISION << "\n";
+		}
 
 		headerFile << "// ### HEADER TERMINATOR ###\n";
 
@@ -108,6 +150,13 @@ void Signal::writeHeader(string signalPath){
 		headerFile << "Signal type: " << type << "\n";
 		headerFile << "Symbol Period (s): " << symbolPeriod << "\n";
 		headerFile << "Sampling Period (s): " << samplingPeriod << "\n";
+		if (valueType == FixedPointValue) {
+			headerFile << "Precision: int16\n";
+			headerFile << "Fixed-point format: Q" << integerBits << "." << fractionBits << "\n";
+		}
+		else {
+			headerFile << "Precision: " << REAL_PRECISION << "\n";
+		}
 
 		headerFile << "// ### HEADER TERMINATOR ###\n";
 
@@ -153,7 +202,28 @@ void Signal::bufferGet(t_real *valueAddr) {
 };
 
 void Signal::bufferGet(t_complex *valueAddr) {
-	*valueAddr = static_cast<t_complex *>(buffer)[outPosition];
+	if (complexLayout == SplitPlanes)
+		*valueAddr = t_complex(realPlane()[outPosition], imagPlane()[outPosition]);
+	else
+		*valueAddr = static_cast<t_complex *>(buffer)[outPosition];
+	if (bufferFull) bufferFull = false;
+	outPosition++;
+	if (outPosition == bufferLength) outPosition = 0;
+	if (outPosition == inPosition) bufferEmpty = true;
+	return;
+};
+
+void Signal::bufferGet(t_fixed *valueAddr) {
+	*valueAddr = static_cast<t_fixed *>(buffer)[outPosition];
+	if (bufferFull) bufferFull = false;
+	outPosition++;
+	if (outPosition == bufferLength) outPosition = 0;
+	if (outPosition == inPosition) bufferEmpty = true;
+	return;
+};
+
+void Signal::bufferGet(t_complex_xy *valueAddr) {
+	*valueAddr = static_cast<t_complex_xy *>(buffer)[outPosition];
 	if (bufferFull) bufferFull = false;
 	outPosition++;
 	if (outPosition == bufferLength) outPosition = 0;
@@ -239,6 +309,15 @@ bool SuperBlock::runBlock() {
 			int space = outputSignals[i]->space();
 			int length = (ready <= space) ? ready : space;
 
+			if (outputSignals[i]->getValueType() == ComplexXYValue) {
+				t_complex_xy signalValue;
+				for (int j = 0; j < length; j++) {
+					moduleBlocks[moduleBlocks.size() - 1]->outputSignals[i]->bufferGet(&signalValue);
+					outputSignals[i]->bufferPut(signalValue);
+				}
+				continue;
+			}
+
 			t_complex signalValue;
 			for (int j = 0; j < length; j++) {
 				moduleBlocks[moduleBlocks.size() - 1]->outputSignals[i]->bufferGet(&signalValue);
@@ -246,6 +325,12 @@ bool SuperBlock::runBlock() {
 			}
 		}
 
+		// Once the input of the super block ended, its module blocks are told in turn, each one when those before it are done.
+		if (!proceed && inputEnded && (endedBlocks < moduleBlocks.size())) {
+			moduleBlocks[endedBlocks++]->endInput();
+			proceed = true;
+		}
+
 	} while (proceed);
 
 	return alive;
@@ -266,6 +351,8 @@ void SuperBlock::terminate() {
 
 void SuperBlock::setSaveInternalSignals(bool sInternalSignals) {
 
+	saveInternalSignals = sInternalSignals;
+
 	for (int unsigned i = 0; i < moduleBlocks.size(); i++) {
 		for (int unsigned j = 0; j < (moduleBlocks[i]->inputSignals).size(); j++)
 			moduleBlocks[i]->inputSignals[j]->setSaveSignal(sInternalSignals);
@@ -288,18 +375,22 @@ void FIR_Filter::initializeFIR_Filter(void) {
 
 	delayLine.resize(impulseResponseLength, 0);
 
-	if (saveImpulseResponse) {
-		ofstream fileHandler("./signals/" + impulseResponseFilename, ios::out);
-		fileHandler << "// ### HEADER TERMINATOR ###\n";
+	if (saveImpulseResponse) writeImpulseResponse();
 
-		t_real t;
-		double samplingPeriod = inputSignals[0]->samplingPeriod;
-		for (int i = 0; i < impulseResponseLength; i++) {
-			t = -impulseResponseLength / 2 * samplingPeriod + i * samplingPeriod;
-			fileHandler << t << " " << impulseResponse[i] << "\n";
-		}
-		fileHandler.close();
+};
+
+void FIR_Filter::writeImpulseResponse(void) {
+
+	ofstream fileHandler("./signals/" + impulseResponseFilename, ios::out);
+	fileHandler << "// ### HEADER TERMINATOR ###\n";
+
+	t_real t;
+	double samplingPeriod = inputSignals[0]->samplingPeriod;
+	for (int i = 0; i < impulseResponseLength; i++) {
+		t = -impulseResponseLength / 2 * samplingPeriod + i * samplingPeriod;
+		fileHandler << t << " " << impulseResponse[i] << "\n";
 	}
+	fileHandler.close();
 
 };
 
@@ -372,17 +463,27 @@ bool RealToComplex::runBlock(void) {
 
 	if (process == 0) return false;
 
-	t_real re;
-	t_real im;
-	for (int i = 0; i < process; i++) {
-
-		inputSignals[0]->bufferGet(&re);
-		inputSignals[1]->bufferGet(&im);
+	// Contiguous runs of the buffers are copied to the planes of a SplitPlanes output, or interleaved.
+	Signal *out = outputSignals[0];
+	while (process > 0) {
+		int n = min(process, min(min(inputSignals[0]->contiguousReady(), inputSignals[1]->contiguousReady()), out->contiguousSpace()));
+		if (n <= 0) break;
 
-		complex<t_real> myComplex( re, im);
+		const t_real *re = static_cast<t_real *>(inputSignals[0]->buffer) + inputSignals[0]->outPosition;
+		const t_real *im = static_cast<t_real *>(inputSignals[1]->buffer) + inputSignals[1]->outPosition;
 
-		outputSignals[0]->bufferPut(myComplex);
+		if (out->getComplexLayout() == SplitPlanes) {
+			copy(re, re + n, out->realPlane() + out->inPosition);
+			copy(im, im + n, out->imagPlane() + out->inPosition);
+		}
+		else {
+			dspKernels().interleave(re, im, static_cast<t_complex *>(out->buffer) + out->inPosition, n);
+		}
 
+		inputSignals[0]->commitGet(n);
+		inputSignals[1]->commitGet(n);
+		out->commitPut(n);
+		process = process - n;
 	}
 
 	return true;
@@ -610,6 +711,8 @@ void System::run() {
 		}
 	} while (Alive);
 
+	drain();
+
 	for (int unsigned i = 0; i < SystemBlocks.size(); i++) {
 		SystemBlocks[i]->terminateBlock();
 	}
@@ -633,8 +736,26 @@ void System::run(string signalPath) {
 		}
 	} while (alive);
 
+	drain();
+
 	for (int unsigned i = 0; i < SystemBlocks.size(); i++) {
 		SystemBlocks[i]->terminateBlock();
 	}
 }
 
+void System::drain() {
+
+	// The blocks are told in turn that their input ended, each one once the blocks before it have output all their samples.
+	for (unsigned int i = 0; i < SystemBlocks.size(); i++) {
+		SystemBlocks[i]->endInput();
+
+		bool alive;
+		do {
+			alive = false;
+			for (unsigned int j = 0; j < SystemBlocks.size(); j++) {
+				bool aux = SystemBlocks[j]->runBlock();
+				alive = (alive || aux);
+			}
+		} while (alive);
+	}
+}
@@ -0,0 +1,100 @@
+
+# include <algorithm>	// std::max
+
+# include "netplus.h"
+# include "optical_amplifier.h"
+# include "dsp_kernels.h"
+
+using namespace std;
+
+OpticalAmplifier::OpticalAmplifier(vector<Signal*> &InputSig, vector<Signal*> &OutputSig) :Block(InputSig, OutputSig) {
+
+	generator.setStream(newDefaultStream());
+}
+
+void OpticalAmplifier::initialize(void) {
+
+	firstTime = false;
+
+	Signal *in = inputSignals[0];
+	Signal *out = outputSignals[0];
+
+	out->setSymbolPeriod(in->getSymbolPeriod());
+	out->setSamplingPeriod(in->getSamplingPeriod());
+	out->setFirstValueToBeSaved(in->getFirstValueToBeSaved());
+	out->setCentralWavelength(in->getCentralWavelength());
+
+	generator.setSeed((seed == -1) ? getRunSeed() : (uint64_t) seed);
+	if (streamId >= 0) generator.setStream((uint64_t) streamId);
+
+	window.initialize(max(measurementLength, 1), 0);
+	noise.resize(2 * window.frameSize);
+	sampleIndex = 0;
+	calibrated = false;
+}
+
+bool OpticalAmplifier::runBlock(void) {
+
+	if (firstTime) initialize();
+
+	bool alive = false;
+
+	// The pending samples are output first, then input is read until the window is full, or until the input has ended, and the window
+	// is amplified.
+	while (true) {
+		if (window.pending() > 0) {
+			if (window.write(outputSignals[0]) > 0) alive = true;
+			if (window.pending() > 0) break;
+		}
+
+		int read = window.read(inputSignals[0]);
+		if (read > 0) alive = true;
+
+		int n = window.filled();
+		if (n == 0) break;
+		if (!window.full() && !(inputEnded && (read == 0))) break;
+
+		amplify(n);
+		window.advance(n);
+	}
+
+	return alive;
+}
+
+void OpticalAmplifier::calibrate(double power) {
+
+	inputPower = power;
+
+	if (mode == NoiseLoading) {
+		gain = 1;
+		noiseDensity = power / (pow(10, osnr_dB / 10) * noisePolarizations * referenceBandwidth);
+		return;
+	}
+
+	if (mode == GainControl) gain = pow(10, gain_dB / 10);
+	else gain = (power > 0) ? 1e-3 * pow(10, outputPower_dBm / 10) / power : 1;
+
+	// Spontaneous emission factor nsp of the noise figure, NF = (1 + 2 nsp (G - 1)) / G, and nsp (G - 1) h nu per polarization.
+	double noiseFigure = pow(10, noiseFigure_dB / 10);
+	double photonEnergy = PLANCK_CONSTANT * inputSignals[0]->getCentralFrequency();
+	noiseDensity = max(0.0, noiseFigure * gain - 1) * photonEnergy / 2;
+}
+
+void OpticalAmplifier::amplify(int n) {
+
+	const DspKernels &kernels = dspKernels();
+	const t_real *x = reinterpret_cast<const t_real *>(window.input(0));
+	t_real *y = reinterpret_cast<t_real *>(window.output(0));
+
+	if (!calibrated || trackPower) {
+		calibrate(kernels.sumOfSquares(x, 2 * n) / n);
+		calibrated = true;
+	}
+
+	// Each quadrature of the noise has half the power noiseDensity / samplingPeriod.
+	double deviation = sqrt(noiseDensity / (2 * inputSignals[0]->getSamplingPeriod()));
+	generator.gaussian(2 * sampleIndex, noise.data(), 2 * n);
+	kernels.realScaleAdd(x, (t_real) sqrt(gain), noise.data(), (t_real) deviation, y, 2 * n);
+
+	sampleIndex = sampleIndex + n;
+}
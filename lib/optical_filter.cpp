@@ -0,0 +1,201 @@
+
+# include <algorithm>	// std::min, std::max, std::copy, std::upper_bound
+# include <fstream>
+# include <map>
+# include <math.h>
+# include <mutex>
+# include <sstream>
+# include <tuple>
+
+# include "netplus.h"
+# include "optical_filter.h"
+# include "dsp_kernels.h"
+# include "worker_pool.h"
+
+using namespace std;
+
+complex<double> OpticalFilterDesign::response(double frequency) const {
+
+	double amplitude_dB = -insertionLoss_dB;
+	double phase = 0;
+
+	double f = frequency - centerFrequencyOffset;
+	switch (filterType) {
+
+		case NoFilter:
+			break;
+
+		case GaussianFilter:
+		case SuperGaussianFilter: {
+			int m = (filterType == GaussianFilter) ? 1 : max(order, 1);
+			amplitude_dB = amplitude_dB - 10 * log10(2.0) * pow(2 * f / bandwidth, 2 * m);
+			break;
+		}
+
+		case MeasuredFilter: {
+			int n = (int) measuredFrequency.size();
+			if (n == 0) break;
+			bool withPhase = (measuredPhase.size() == measuredFrequency.size());
+
+			int k = (int)(upper_bound(measuredFrequency.begin(), measuredFrequency.end(), f) - measuredFrequency.begin());
+			if (k == 0) {
+				amplitude_dB = amplitude_dB - measuredAttenuation_dB[0];
+				if (withPhase) phase = measuredPhase[0];
+			}
+			else if (k == n) {
+				amplitude_dB = amplitude_dB - measuredAttenuation_dB[n - 1];
+				if (withPhase) phase = measuredPhase[n - 1];
+			}
+			else {
+				double w = (f - measuredFrequency[k - 1]) / (measuredFrequency[k] - measuredFrequency[k - 1]);
+				amplitude_dB = amplitude_dB - ((1 - w) * measuredAttenuation_dB[k - 1] + w * measuredAttenuation_dB[k]);
+				if (withPhase) phase = (1 - w) * measuredPhase[k - 1] + w * measuredPhase[k];
+			}
+			break;
+		}
+	};
+
+	// Dispersion in SI units, as in FiberSpan, accumulated over the length.
+	double beta2, beta3;
+	dispersionCoefficients(accumulatedDispersion_ps_nm * 1e-3, accumulatedDispersionSlope_ps_nm2 * 1e6, centralWavelength, beta2, beta3);
+	double omega = 2 * PI * frequency;
+	phase = phase + beta2 / 2 * omega * omega - beta3 / 6 * omega * omega * omega;
+
+	return polar(pow(10.0, amplitude_dB / 20), phase);
+}
+
+bool OpticalFilterDesign::operator<(const OpticalFilterDesign &other) const {
+
+	return tie(filterType, bandwidth, order, centerFrequencyOffset, insertionLoss_dB, accumulatedDispersion_ps_nm, accumulatedDispersionSlope_ps_nm2,
+		centralWavelength, measuredFrequency, measuredAttenuation_dB, measuredPhase)
+		< tie(other.filterType, other.bandwidth, other.order, other.centerFrequencyOffset, other.insertionLoss_dB, other.accumulatedDispersion_ps_nm,
+		other.accumulatedDispersionSlope_ps_nm2, other.centralWavelength, other.measuredFrequency, other.measuredAttenuation_dB, other.measuredPhase);
+}
+
+OpticalFilterResponse::OpticalFilterResponse(const OpticalFilterDesign &design, double samplingPeriod, int samplesPerSymbol, int fftSize, int guardLength) {
+
+	if (guardLength > 0) {
+		guard = guardLength;
+	}
+	else {
+		auto impulseResponse = [&](double f, complex<double> *h) { h[0] = design.response(f); };
+		guard = max(impulseResponseGuard(impulseResponse, 1, samplingPeriod, "OpticalFilter"), 1);
+	}
+	guard = symbolAlignedGuard(guard, samplesPerSymbol);
+
+	frameSize = overlapSaveFrameSize(fftSize, guard);
+
+	plan = getFftPlan(frameSize);
+
+	response.resize(frameSize);
+	for (int k = 0; k < frameSize; k++) response[k] = (t_complex)(design.response(binFrequency(k, frameSize, samplingPeriod)) / (double) frameSize);
+}
+
+shared_ptr<const OpticalFilterResponse> getOpticalFilterResponse(const OpticalFilterDesign &design, double samplingPeriod, int samplesPerSymbol, int fftSize, int guardLength) {
+
+	static mutex cacheMutex;
+	static map<tuple<OpticalFilterDesign, double, int, int, int>, shared_ptr<const OpticalFilterResponse>> cache;
+
+	tuple<OpticalFilterDesign, double, int, int, int> key{ design, samplingPeriod, samplesPerSymbol, fftSize, guardLength };
+
+	lock_guard<mutex> lock(cacheMutex);
+
+	shared_ptr<const OpticalFilterResponse> &filter = cache[key];
+	if (!filter) filter = make_shared<const OpticalFilterResponse>(design, samplingPeriod, samplesPerSymbol, fftSize, guardLength);
+
+	return filter;
+}
+
+void OpticalFilter::setMeasuredResponse(vector<double> frequency, vector<double> attenuation_dB, vector<double> phase) {
+
+	design.filterType = MeasuredFilter;
+	design.measuredFrequency = frequency;
+	design.measuredAttenuation_dB = attenuation_dB;
+	design.measuredPhase = phase;
+}
+
+void OpticalFilter::initialize(void) {
+
+	firstTime = false;
+	filter.reset();
+
+	Signal *in = inputSignals[0];
+	Signal *out = outputSignals[0];
+
+	out->setSymbolPeriod(in->getSymbolPeriod());
+	out->setSamplingPeriod(in->getSamplingPeriod());
+	out->setFirstValueToBeSaved(in->getFirstValueToBeSaved());
+	out->setCentralWavelength(in->getCentralWavelength());
+
+	if (responseFileName != "") {
+		// Without its measured points the filter would silently be flat, so the block outputs nothing instead.
+		ifstream fileHandler(responseFileName, ios::in);
+		if (!fileHandler) {
+			cerr << "OpticalFilter: the response file " << responseFileName << " cannot be opened, the filter outputs nothing" << endl;
+			return;
+		}
+
+		vector<double> frequency, attenuation_dB, phase;
+		string line;
+		while (getline(fileHandler, line)) {
+			if (line.compare(0, 2, "//") == 0) continue;
+			istringstream fields(line);
+			double f, a, p;
+			if (!(fields >> f >> a)) continue;
+			frequency.push_back(f * 1e9);
+			attenuation_dB.push_back(a);
+			if (fields >> p) phase.push_back(p);
+		}
+		if (frequency.empty()) {
+			cerr << "OpticalFilter: the response file " << responseFileName << " has no points, the filter outputs nothing" << endl;
+			return;
+		}
+		setMeasuredResponse(frequency, attenuation_dB, (phase.size() == frequency.size()) ? phase : vector<double>());
+	}
+
+	design.centralWavelength = in->getCentralWavelength();
+
+	filter = getOpticalFilterResponse(design, in->getSamplingPeriod(), (int) round(in->getSamplesPerSymbol()), fftSize, guardLength);
+	frame.initialize(filter->frameSize, filter->guard);
+}
+
+bool OpticalFilter::runBlock(void) {
+
+	if (firstTime) initialize();
+	if (!filter) return false;
+
+	const DspKernels &kernels = dspKernels();
+	int threads = (numberOfThreads > 0) ? min(numberOfThreads, workerPool().size()) : workerPool().size();
+	int frameSize = filter->frameSize;
+
+	bool alive = false;
+
+	// The pending samples are output first, then input is read until the frame is full, or until the input has ended, and the frame is
+	// filtered, zero-padded if it is the last one.
+	while (true) {
+		if (frame.pending() > 0) {
+			if (frame.write(outputSignals[0]) > 0) alive = true;
+			if (frame.pending() > 0) break;
+		}
+
+		int read = frame.read(inputSignals[0]);
+		if (read > 0) alive = true;
+
+		int samples = frame.newSamples;
+		if (!frame.full()) {
+			samples = frame.filled();
+			if ((samples == 0) || !(inputEnded && (read == 0))) break;
+			frame.padFrames();
+		}
+
+		t_complex *filtered = frame.output(0);
+		copy(frame.input(0), frame.input(0) + frameSize, filtered);
+		filter->plan->forward(filtered, threads);
+		kernels.complexMultiply(filtered, filter->response.data(), filtered, frameSize);
+		filter->plan->inverse(filtered, threads);
+
+		frame.advance(samples);
+	}
+
+	return alive;
+}
@@ -0,0 +1,186 @@
+
+# include <algorithm>	// std::min, std::max, std::copy, std::fill
+# include <math.h>
+
+# include "netplus.h"
+# include "overlap_save.h"
+# include "fft.h"
+# include "dsp_kernels.h"
+
+using namespace std;
+
+double binFrequency(int k, int size, double samplingPeriod) {
+	return ((k < size / 2) ? k : k - size) / (size * samplingPeriod);
+}
+
+void dispersionCoefficients(double dispersion, double dispersionSlope, double wavelength, double &beta2, double &beta3) {
+
+	double lambda = wavelength;
+	beta2 = -dispersion * lambda * lambda / (2 * PI * SPEED_OF_LIGHT);
+	beta3 = pow(lambda * lambda / (2 * PI * SPEED_OF_LIGHT), 2) * (dispersionSlope + 2 * dispersion / lambda);
+}
+
+int impulseResponseGuard(const function<void(double, complex<double> *)> &response, int numberOfResponses, double samplingPeriod, string blockName) {
+
+	const int MAX_GRID_SIZE = 1 << 22;
+	const double TAPER_START = 0.8;			// fraction of the Nyquist frequency
+
+	vector<complex<double>> values(numberOfResponses);
+	for (int size = 1 << 12; ; size = 2 * size) {
+		vector<vector<t_complex>> h(numberOfResponses, vector<t_complex>(size));
+		for (int k = 0; k < size; k++) {
+			double f = binFrequency(k, size, samplingPeriod);
+			double r = fabs(f) * 2 * samplingPeriod;
+			double taper = (r < TAPER_START) ? 1 : 0.5 + 0.5 * cos(PI * (r - TAPER_START) / (1 - TAPER_START));
+			response(f, values.data());
+			for (int e = 0; e < numberOfResponses; e++) h[e][k] = (t_complex)(values[e] * taper);
+		}
+
+		vector<double> energy(size, 0);
+		for (int e = 0; e < numberOfResponses; e++) {
+			getFftPlan(size)->inverse(h[e].data());
+			for (int k = 0; k < size; k++) energy[k] = energy[k] + norm(h[e][k]);
+		}
+
+		double total = 0;
+		for (int k = 0; k < size; k++) total = total + energy[k];
+
+		double inside = energy[0];
+		int guard = 0;
+		while ((guard < size / 2 - 1) && (total - inside > FILTER_TRUNCATION * total)) {
+			guard++;
+			inside = inside + energy[guard] + energy[size - guard];
+		}
+
+		if (4 * guard <= size) return guard;
+		if (size == MAX_GRID_SIZE) {
+			cerr << blockName << ": the impulse response is longer than " << size / 4 << " samples, it is truncated" << endl;
+			return size / 4;
+		}
+	}
+}
+
+int symbolAlignedGuard(int guard, int samplesPerSymbol) {
+
+	if (samplesPerSymbol > 1) guard = (guard + samplesPerSymbol - 1) / samplesPerSymbol * samplesPerSymbol;
+	return guard;
+}
+
+int overlapSaveFrameSize(int fftSize, int guard) {
+
+	int frameSize = nextPowerOfTwo(max(fftSize, 1));
+	if (fftSize == 0) frameSize = nextPowerOfTwo(max(8 * guard, 1024));
+	if (frameSize < 4 * guard) frameSize = nextPowerOfTwo(4 * guard);
+	return frameSize;
+}
+
+// Copies of n samples between a buffer and the Signal read or written position.
+static void readSignal(Signal *in, t_complex *dst, int n) {
+
+	if (in->getComplexLayout() == SplitPlanes) {
+		dspKernels().interleave(in->realPlane() + in->outPosition, in->imagPlane() + in->outPosition, dst, n);
+	}
+	else {
+		const t_complex *src = static_cast<t_complex *>(in->buffer) + in->outPosition;
+		copy(src, src + n, dst);
+	}
+}
+
+static void readSignal(Signal *in, t_complex_xy *dst, int n) {
+
+	const t_complex_xy *src = static_cast<t_complex_xy *>(in->buffer) + in->outPosition;
+	copy(src, src + n, dst);
+}
+
+static void writeSignal(Signal *out, const t_complex *src, int n) {
+
+	if (out->getComplexLayout() == SplitPlanes) {
+		dspKernels().deinterleave(src, out->realPlane() + out->inPosition, out->imagPlane() + out->inPosition, n);
+	}
+	else {
+		copy(src, src + n, static_cast<t_complex *>(out->buffer) + out->inPosition);
+	}
+}
+
+static void writeSignal(Signal *out, const t_complex_xy *src, int n) {
+
+	copy(src, src + n, static_cast<t_complex_xy *>(out->buffer) + out->inPosition);
+}
+
+template<class T>
+void OverlapSaveBuffer<T>::initialize(int fSize, int g, int frames) {
+
+	frameSize = fSize;
+	guard = g;
+	newSamples = frameSize - 2 * guard;
+	batchFrames = max(frames, 1);
+
+	inputBatch.assign(2 * guard + (size_t) batchFrames * newSamples, T());
+	inputFilled = 2 * guard;
+	outputBatch.assign((size_t) batchFrames * frameSize, T());
+	outputSamples = 0;
+	pendingSamples = 0;
+}
+
+template<class T>
+int OverlapSaveBuffer<T>::read(Signal *in) {
+
+	int total = 0;
+	while (inputFilled < (int) inputBatch.size()) {
+		int n = min((int) inputBatch.size() - inputFilled, in->contiguousReady());
+		if (n <= 0) break;
+
+		readSignal(in, inputBatch.data() + inputFilled, n);
+
+		in->commitGet(n);
+		inputFilled = inputFilled + n;
+		total = total + n;
+	}
+
+	return total;
+}
+
+template<class T>
+int OverlapSaveBuffer<T>::write(Signal *out) {
+
+	int total = 0;
+	while (pendingSamples > 0) {
+		int sample = outputSamples - pendingSamples;
+		int frame = sample / newSamples;
+		int offset = sample % newSamples;
+
+		int n = min(min(newSamples - offset, pendingSamples), out->contiguousSpace());
+		if (n <= 0) break;
+
+		writeSignal(out, outputBatch.data() + (size_t) frame * frameSize + guard + offset, n);
+
+		out->commitPut(n);
+		pendingSamples = pendingSamples - n;
+		total = total + n;
+	}
+
+	return total;
+}
+
+template<class T>
+int OverlapSaveBuffer<T>::padFrames(void) {
+
+	// The zeros stand for the signal after the end of the input, which the last output samples see within their guard.
+	int frames = (filled() + newSamples - 1) / newSamples;
+	fill(inputBatch.begin() + inputFilled, inputBatch.begin() + 2 * guard + (size_t) frames * newSamples, T());
+	return frames;
+}
+
+template<class T>
+void OverlapSaveBuffer<T>::advance(int samples) {
+
+	// The samples after the ones processed, the 2 * guard that start the next frame included, move to the start of the batch.
+	copy(inputBatch.begin() + samples, inputBatch.begin() + inputFilled, inputBatch.begin());
+	inputFilled = inputFilled - samples;
+
+	outputSamples = samples;
+	pendingSamples = samples;
+}
+
+template class OverlapSaveBuffer<t_complex>;
+template class OverlapSaveBuffer<t_complex_xy>;
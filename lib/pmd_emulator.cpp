@@ -0,0 +1,169 @@
+
+# include <algorithm>	// std::min, std::max
+# include <math.h>
+
+# include "netplus.h"
+# include "pmd_emulator.h"
+# include "polarization_element.h"	// jonesProduct
+# include "dsp_kernels.h"
+# include "worker_pool.h"
+
+using namespace std;
+
+// Frequency step of the derivative of the DGD, relative to 1/DGD; the float products of a single precision build need a longer one.
+# ifdef NETPLUS_SINGLE_PRECISION
+const double DGD_STEP = 3e-3;
+# else
+const double DGD_STEP = 1e-4;
+# endif
+
+// Product D(f) U_k of all the sections, the first one applied first.
+static t_jones pmdResponse(const vector<t_jones> &rotations, double sectionDgd, double frequency) {
+
+	t_jones h{ t_complex(1, 0), t_complex(1, 0), t_complex(0, 0), t_complex(0, 0) };
+	t_complex delay = polar((t_real) 1, (t_real)(PI * frequency * sectionDgd));
+	for (const t_jones &u : rotations) {
+		t_jones section{ delay * u.xx, conj(delay) * u.yy, delay * u.xy, conj(delay) * u.yx };
+		h = jonesProduct(section, h);
+	}
+	return h;
+}
+
+PmdEmulator::PmdEmulator(vector<Signal*> &InputSig, vector<Signal*> &OutputSig) :Block(InputSig, OutputSig) {
+
+	generator.setStream(newDefaultStream());
+}
+
+t_jones PmdEmulator::jonesMatrix(double frequency) const {
+
+	return pmdResponse(rotations, sectionDgd, frequency);
+}
+
+// For the unitary H(w), dH/dw = -j/2 (tau . sigma) H, so |det dH/dw| = DGD^2 / 4; the derivative is a central difference.
+double PmdEmulator::differentialGroupDelay(double frequency) const {
+
+	double totalDgd = max(sectionDgd * rotations.size(), 1e-18);
+	double df = DGD_STEP / totalDgd;
+	t_jones above = pmdResponse(rotations, sectionDgd, frequency + df);
+	t_jones below = pmdResponse(rotations, sectionDgd, frequency - df);
+
+	double dw = 2 * PI * 2 * df;
+	complex<double> dxx = complex<double>(above.xx - below.xx) / dw, dyy = complex<double>(above.yy - below.yy) / dw;
+	complex<double> dxy = complex<double>(above.xy - below.xy) / dw, dyx = complex<double>(above.yx - below.yx) / dw;
+	return 2 * sqrt(abs(dxx * dyy - dxy * dyx));
+}
+
+void PmdEmulator::initialize(void) {
+
+	firstTime = false;
+
+	Signal *in = inputSignals[0];
+	Signal *out = outputSignals[0];
+
+	out->setSymbolPeriod(in->getSymbolPeriod());
+	out->setSamplingPeriod(in->getSamplingPeriod());
+	out->setFirstValueToBeSaved(in->getFirstValueToBeSaved());
+	out->setCentralWavelength(in->getCentralWavelength());
+
+	generator.setSeed((seed == -1) ? getRunSeed() : (uint64_t) seed);
+	if (streamId >= 0) generator.setStream((uint64_t) streamId);
+
+	// Haar distributed rotations: U = [a  -b*; b  a*], with (a, b) a uniform point of the unit sphere of C^2.
+	int sections = max(numberOfSections, 0);
+	vector<t_real> g(4 * sections);
+	generator.gaussian(0, g.data(), 4 * sections);
+	rotations.resize(sections);
+	for (int k = 0; k < sections; k++) {
+		double r = sqrt((double) g[4 * k] * g[4 * k] + (double) g[4 * k + 1] * g[4 * k + 1] + (double) g[4 * k + 2] * g[4 * k + 2] + (double) g[4 * k + 3] * g[4 * k + 3]);
+		t_complex a((t_real)(g[4 * k] / r), (t_real)(g[4 * k + 1] / r));
+		t_complex b((t_real)(g[4 * k + 2] / r), (t_real)(g[4 * k + 3] / r));
+		rotations[k] = t_jones{ a, conj(a), -conj(b), b };
+	}
+	sectionDgd = (sections > 0) ? meanDgd * sqrt(3 * PI / (8.0 * sections)) : 0;
+
+	double samplingPeriod = in->getSamplingPeriod();
+	int samplesPerSymbol = (int) round(in->getSamplesPerSymbol());
+
+	if (guardLength > 0) {
+		guard = guardLength;
+	}
+	else {
+		auto impulseResponses = [&](double f, complex<double> *h) {
+			t_jones j = pmdResponse(rotations, sectionDgd, f);
+			h[0] = j.xx;
+			h[1] = j.yy;
+			h[2] = j.xy;
+			h[3] = j.yx;
+		};
+		guard = max(impulseResponseGuard(impulseResponses, 4, samplingPeriod, "PmdEmulator"), 1);
+	}
+	guard = symbolAlignedGuard(guard, samplesPerSymbol);
+	frameSize = overlapSaveFrameSize(fftSize, guard);
+
+	plan = getFftPlan(frameSize);
+
+	response.resize(frameSize);
+	for (int k = 0; k < frameSize; k++) {
+		t_jones h = pmdResponse(rotations, sectionDgd, binFrequency(k, frameSize, samplingPeriod));
+		t_real scale = (t_real) 1 / frameSize;
+		response[k] = t_jones{ h.xx * scale, h.yy * scale, h.xy * scale, h.yx * scale };
+	}
+
+	frame.initialize(frameSize, guard);
+	spectrumX.resize(frameSize);
+	spectrumY.resize(frameSize);
+}
+
+bool PmdEmulator::runBlock(void) {
+
+	if (firstTime) initialize();
+
+	const DspKernels &kernels = dspKernels();
+	int threads = (numberOfThreads > 0) ? min(numberOfThreads, workerPool().size()) : workerPool().size();
+
+	bool alive = false;
+
+	// The pending samples are output first, then input is read until the frame is full, or until the input has ended, and the frame is
+	// filtered, zero-padded if it is the last one: the spectra of the two polarizations are interleaved again so that every bin is
+	// transformed by its Jones matrix in one pass.
+	while (true) {
+		if (frame.pending() > 0) {
+			if (frame.write(outputSignals[0]) > 0) alive = true;
+			if (frame.pending() > 0) break;
+		}
+
+		int read = frame.read(inputSignals[0]);
+		if (read > 0) alive = true;
+
+		int samples = frame.newSamples;
+		if (!frame.full()) {
+			samples = frame.filled();
+			if ((samples == 0) || !(inputEnded && (read == 0))) break;
+			frame.padFrames();
+		}
+
+		const t_complex_xy *input = frame.input(0);
+		for (int k = 0; k < frameSize; k++) {
+			spectrumX[k] = input[k].x;
+			spectrumY[k] = input[k].y;
+		}
+		plan->forward(spectrumX.data(), threads);
+		plan->forward(spectrumY.data(), threads);
+		t_complex_xy *filtered = frame.output(0);
+		for (int k = 0; k < frameSize; k++) filtered[k] = t_complex_xy{ spectrumX[k], spectrumY[k] };
+
+		kernels.jonesMatrices(filtered, response.data(), filtered, frameSize);
+
+		for (int k = 0; k < frameSize; k++) {
+			spectrumX[k] = filtered[k].x;
+			spectrumY[k] = filtered[k].y;
+		}
+		plan->inverse(spectrumX.data(), threads);
+		plan->inverse(spectrumY.data(), threads);
+		for (int k = 0; k < frameSize; k++) filtered[k] = t_complex_xy{ spectrumX[k], spectrumY[k] };
+
+		frame.advance(samples);
+	}
+
+	return alive;
+}
@@ -0,0 +1,82 @@
+
+# include <algorithm>	// std::min
+# include <math.h>
+
+# include "netplus.h"
+# include "polarization_element.h"
+# include "dsp_kernels.h"
+
+using namespace std;
+
+t_jones jonesProduct(const t_jones &a, const t_jones &b) {
+
+	t_jones p;
+	p.xx = a.xx * b.xx + a.xy * b.yx;
+	p.xy = a.xx * b.xy + a.xy * b.yy;
+	p.yx = a.yx * b.xx + a.yy * b.yx;
+	p.yy = a.yx * b.xy + a.yy * b.yy;
+	return p;
+}
+
+// R(angle) diag(a, b) R(-angle)
+static t_jones rotatedDiagonal(t_complex a, t_complex b, double angle) {
+
+	t_real c = (t_real) cos(angle), s = (t_real) sin(angle);
+	t_jones r{ t_complex(c, 0), t_complex(c, 0), t_complex(-s, 0), t_complex(s, 0) };
+	t_jones d{ a, b, t_complex(0, 0), t_complex(0, 0) };
+	t_jones rInverse{ r.xx, r.yy, r.yx, r.xy };
+	return jonesProduct(jonesProduct(r, d), rInverse);
+}
+
+void PolarizationElement::initialize(void) {
+
+	firstTime = false;
+
+	Signal *in = inputSignals[0];
+	Signal *out = outputSignals[0];
+
+	out->setSymbolPeriod(in->getSymbolPeriod());
+	out->setSamplingPeriod(in->getSamplingPeriod());
+	out->setFirstValueToBeSaved(in->getFirstValueToBeSaved());
+	out->setCentralWavelength(in->getCentralWavelength());
+
+	if (userMatrix) return;
+
+	t_real c = (t_real) cos(rotationAngle), s = (t_real) sin(rotationAngle);
+	t_jones rotation{ t_complex(c, 0), t_complex(c, 0), t_complex(-s, 0), t_complex(s, 0) };
+	t_jones retarder = rotatedDiagonal(polar((t_real) 1, (t_real)(retardance / 2)), polar((t_real) 1, (t_real)(-retardance / 2)), retarderAngle);
+	t_jones pdl = rotatedDiagonal(t_complex(1, 0), t_complex((t_real) pow(10, -pdl_dB / 20), 0), pdlAngle);
+
+	matrix = jonesProduct(pdl, jonesProduct(retarder, rotation));
+
+	t_real loss = (t_real) pow(10, -insertionLoss_dB / 20);
+	matrix.xx = loss * matrix.xx;
+	matrix.yy = loss * matrix.yy;
+	matrix.xy = loss * matrix.xy;
+	matrix.yx = loss * matrix.yx;
+}
+
+bool PolarizationElement::runBlock(void) {
+
+	if (firstTime) initialize();
+
+	Signal *in = inputSignals[0];
+	Signal *out = outputSignals[0];
+	const DspKernels &kernels = dspKernels();
+
+	bool alive = false;
+	while (true) {
+		int n = min(in->contiguousReady(), out->contiguousSpace());
+		if (n <= 0) break;
+
+		const t_complex_xy *src = static_cast<t_complex_xy *>(in->buffer) + in->outPosition;
+		t_complex_xy *dst = static_cast<t_complex_xy *>(out->buffer) + out->inPosition;
+		kernels.jonesMatrix(src, &matrix, dst, n);
+
+		in->commitGet(n);
+		out->commitPut(n);
+		alive = true;
+	}
+
+	return alive;
+}
@@ -0,0 +1,115 @@
+
+# include <algorithm>	// std::min
+
+# include "netplus.h"
+# include "polarization_multiplexer.h"
+
+using namespace std;
+
+// Copies n samples of a BandpassSignal, from outPosition on, into one polarization of xy.
+static void getPolarization(Signal *in, t_complex t_complex_xy::*polarization, t_complex_xy *xy, int n) {
+
+	if (in->getComplexLayout() == SplitPlanes) {
+		const t_real *re = in->realPlane() + in->outPosition;
+		const t_real *im = in->imagPlane() + in->outPosition;
+		for (int k = 0; k < n; k++) xy[k].*polarization = t_complex(re[k], im[k]);
+	}
+	else {
+		const t_complex *src = static_cast<t_complex *>(in->buffer) + in->outPosition;
+		for (int k = 0; k < n; k++) xy[k].*polarization = src[k];
+	}
+	in->commitGet(n);
+}
+
+// Copies one polarization of n samples of xy into a BandpassSignal, from inPosition on.
+static void putPolarization(const t_complex_xy *xy, t_complex t_complex_xy::*polarization, Signal *out, int n) {
+
+	if (out->getComplexLayout() == SplitPlanes) {
+		t_real *re = out->realPlane() + out->inPosition;
+		t_real *im = out->imagPlane() + out->inPosition;
+		for (int k = 0; k < n; k++) {
+			re[k] = (xy[k].*polarization).real();
+			im[k] = (xy[k].*polarization).imag();
+		}
+	}
+	else {
+		t_complex *dst = static_cast<t_complex *>(out->buffer) + out->inPosition;
+		for (int k = 0; k < n; k++) dst[k] = xy[k].*polarization;
+	}
+	out->commitPut(n);
+}
+
+static void copySignalParameters(Signal *in, Signal *out) {
+
+	out->setSymbolPeriod(in->getSymbolPeriod());
+	out->setSamplingPeriod(in->getSamplingPeriod());
+	out->setFirstValueToBeSaved(in->getFirstValueToBeSaved());
+	out->setCentralWavelength(in->getCentralWavelength());
+}
+
+void PolarizationMultiplexer::initialize(void) {
+
+	firstTime = false;
+
+	if (inputSignals[0]->getSamplingPeriod() != inputSignals[1]->getSamplingPeriod()) {
+		cerr << "PolarizationMultiplexer: the X and Y inputs have different sampling periods, the one of X is used" << endl;
+	}
+
+	copySignalParameters(inputSignals[0], outputSignals[0]);
+}
+
+bool PolarizationMultiplexer::runBlock(void) {
+
+	if (firstTime) initialize();
+
+	Signal *inX = inputSignals[0];
+	Signal *inY = inputSignals[1];
+	Signal *out = outputSignals[0];
+
+	bool alive = false;
+	while (true) {
+		int n = min(min(inX->contiguousReady(), inY->contiguousReady()), out->contiguousSpace());
+		if (n <= 0) break;
+
+		t_complex_xy *dst = static_cast<t_complex_xy *>(out->buffer) + out->inPosition;
+		getPolarization(inX, &t_complex_xy::x, dst, n);
+		getPolarization(inY, &t_complex_xy::y, dst, n);
+		out->commitPut(n);
+
+		alive = true;
+	}
+
+	return alive;
+}
+
+void PolarizationDemultiplexer::initialize(void) {
+
+	firstTime = false;
+
+	copySignalParameters(inputSignals[0], outputSignals[0]);
+	copySignalParameters(inputSignals[0], outputSignals[1]);
+}
+
+bool PolarizationDemultiplexer::runBlock(void) {
+
+	if (firstTime) initialize();
+
+	Signal *in = inputSignals[0];
+	Signal *outX = outputSignals[0];
+	Signal *outY = outputSignals[1];
+
+	bool alive = false;
+	while (true) {
+		int n = min(in->contiguousReady(), min(outX->contiguousSpace(), outY->contiguousSpace()));
+		if (n <= 0) break;
+
+		const t_complex_xy *src = static_cast<t_complex_xy *>(in->buffer) + in->outPosition;
+		putPolarization(src, &t_complex_xy::x, outX, n);
+		putPolarization(src, &t_complex_xy::y, outY, n);
+		in->commitGet(n);
+
+		alive = true;
+	}
+
+	return alive;
+}
@@ -0,0 +1,219 @@
+# include <algorithm>	// min
+
+# include "netplus.h"
+# include "polyphase_pulse_shaper.h"
+# include "dsp_kernels.h"
+
+using namespace std;
+
+const int FIXED_POINT_SPAN = 256;		// symbols shaped at a time with a fixed-point input
+
+static inline t_real dotProduct(const DspKernels &kernels, const t_real *window, const t_real *taps, int n) {
+	return kernels.dotProduct(window, taps, n);
+}
+
+// I and Q are interleaved in memory, both components are accumulated in the same pass.
+static inline t_complex dotProduct(const DspKernels &kernels, const t_complex *window, const t_real *taps, int n) {
+	return kernels.complexDotProduct(window, taps, n);
+}
+
+void PolyphasePulseShaper::initialize(void) {
+
+	outputSignals[0]->symbolPeriod = inputSignals[0]->symbolPeriod;
+	outputSignals[0]->samplingPeriod = inputSignals[0]->samplingPeriod / numberOfSamplesPerSymbol;
+	outputSignals[0]->samplesPerSymbol = numberOfSamplesPerSymbol;
+	outputSignals[0]->setFirstValueToBeSaved(inputSignals[0]->getFirstValueToBeSaved());
+
+	double samplingPeriod = outputSignals[0]->samplingPeriod;
+	double symbolPeriod = outputSignals[0]->symbolPeriod;
+
+	impulseResponse = getPulseShaperTaps(getFilterType(), rollOffFactor, impulseResponseTimeLength, samplingPeriod, symbolPeriod);
+	impulseResponseLength = impulseResponse->size();
+
+	// Branch p holds the taps p, p + sps, p + 2 sps, ..., reversed so that they line up with the symbol history (oldest symbol first).
+	numberOfTapsPerPhase = (impulseResponseLength + numberOfSamplesPerSymbol - 1) / numberOfSamplesPerSymbol;
+	polyphaseTaps.assign(numberOfSamplesPerSymbol * numberOfTapsPerPhase, 0.0);
+	for (int p = 0; p < numberOfSamplesPerSymbol; p++) {
+		for (int m = 0; m < numberOfTapsPerPhase; m++) {
+			int tap = p + m * numberOfSamplesPerSymbol;
+			if (tap < impulseResponseLength)
+				polyphaseTaps[p * numberOfTapsPerPhase + (numberOfTapsPerPhase - 1 - m)] = (*impulseResponse)[tap];
+		}
+	}
+
+	symbolHistory.clear();
+	complexSymbolHistory.clear();
+	fixedSymbolHistory.clear();
+	fixedPolyphaseTaps.clear();
+	fixedFirKernel = nullptr;
+	fixedTapPairs.clear();
+	fixedOutputsPending = 0;
+
+	if (inputSignals[0]->getValueType() == ComplexValue) {
+		complexSymbolHistory.assign(2 * numberOfTapsPerPhase, 0.0);
+	}
+	else if (inputSignals[0]->getValueType() == FixedPointValue) {
+		// The most negative code is never used for the taps, so the integer kernels cannot overflow.
+		fixedPolyphaseTaps.resize(polyphaseTaps.size());
+		for (unsigned int i = 0; i < polyphaseTaps.size(); i++)
+			fixedPolyphaseTaps[i] = max(tapsFixedPointFormat.quantize(polyphaseTaps[i]), (t_fixed)(-tapsFixedPointFormat.maxCode()));
+		fixedSymbolHistory.assign(numberOfTapsPerPhase - 1 + FIXED_POINT_SPAN, 0);
+		fixedAccumulators.assign(FIXED_POINT_SPAN * numberOfSamplesPerSymbol, 0);
+		fixedOutputs.assign(FIXED_POINT_SPAN * numberOfSamplesPerSymbol, 0);
+		outputFixedPointFormat.setFormatOf(outputSignals[0]);
+
+		// The 32-bit kernel is only used when no sum of the input format can overflow it.
+		if (specializedKernels && (numberOfTapsPerPhase % 2 == 0)) {
+			fixedTapPairs.resize(fixedPolyphaseTaps.size());
+			for (int p = 0; p < numberOfSamplesPerSymbol; p++)
+				for (int m = 0; m < numberOfTapsPerPhase; m++)
+					fixedTapPairs[2 * ((m / 2) * numberOfSamplesPerSymbol + p) + (m % 2)] = fixedPolyphaseTaps[p * numberOfTapsPerPhase + m];
+
+			int maxSymbolCode = 1 << (inputSignals[0]->getIntegerBits() + inputSignals[0]->getFractionBits());
+			if (fixedPolyphaseFirFits(fixedTapPairs.data(), numberOfSamplesPerSymbol, numberOfTapsPerPhase, maxSymbolCode))
+				fixedFirKernel = getFixedPolyphaseFirKernel(numberOfSamplesPerSymbol, numberOfTapsPerPhase);
+		}
+	}
+	else {
+		symbolHistory.assign(2 * numberOfTapsPerPhase, 0.0);
+	}
+
+	// Common shapes use a kernel with the number of branches and of taps fixed at compile time.
+	firKernel = nullptr;
+	complexFirKernel = nullptr;
+	tapMajorTaps.clear();
+	if (specializedKernels) {
+		if (!symbolHistory.empty()) firKernel = getPolyphaseFirKernel(numberOfSamplesPerSymbol, numberOfTapsPerPhase);
+		if (!complexSymbolHistory.empty()) complexFirKernel = getComplexPolyphaseFirKernel(numberOfSamplesPerSymbol, numberOfTapsPerPhase);
+	}
+	if ((firKernel != nullptr) || (complexFirKernel != nullptr)) {
+		tapMajorTaps.resize(polyphaseTaps.size());
+		for (int p = 0; p < numberOfSamplesPerSymbol; p++)
+			for (int m = 0; m < numberOfTapsPerPhase; m++)
+				tapMajorTaps[m * numberOfSamplesPerSymbol + p] = polyphaseTaps[p * numberOfTapsPerPhase + m];
+	}
+	symbolOutputs.assign((firKernel != nullptr) ? numberOfSamplesPerSymbol : 0, 0.0);
+	complexSymbolOutputs.assign((complexFirKernel != nullptr) ? numberOfSamplesPerSymbol : 0, 0.0);
+	historyPosition = 0;
+	phase = 0;
+
+	if (!getSeeBeginningOfImpulseResponse()) {
+		int aux = (int)(((double)impulseResponseLength) / 2) + 1;
+		outputSignals[0]->setFirstValueToBeSaved(aux);
+	}
+
+	if (saveImpulseResponse) impulseResponse->save("./signals/" + impulseResponseFilename, samplingPeriod);
+
+}
+
+bool PolyphasePulseShaper::runBlock(void) {
+
+	if (!fixedSymbolHistory.empty()) return shapeFixedPoint();
+
+	if (complexSymbolHistory.empty())
+		return shape(symbolHistory, firKernel, symbolOutputs);
+	else
+		return shape(complexSymbolHistory, complexFirKernel, complexSymbolOutputs);
+};
+
+template<typename T>
+bool PolyphasePulseShaper::shape(vector<T> &history, void(*kernel)(const T *, const t_real *, T *), vector<T> &outputs) {
+
+	int ready = inputSignals[0]->ready();
+	int space = outputSignals[0]->space();
+
+	const DspKernels &kernels = dspKernels();
+
+	bool alive{ false };
+
+	while (space > 0) {
+
+		if (phase == 0) {
+			if (ready == 0) break;
+
+			T value;
+			inputSignals[0]->bufferGet(&value);
+			ready--;
+
+			history[historyPosition] = value;
+			history[historyPosition + numberOfTapsPerPhase] = value;
+			historyPosition++;
+			if (historyPosition == numberOfTapsPerPhase) historyPosition = 0;
+
+			if (kernel != nullptr) kernel(&history[historyPosition], tapMajorTaps.data(), outputs.data());
+		}
+
+		T value;
+		if (kernel != nullptr)
+			value = outputs[phase];
+		else
+			value = dotProduct(kernels, &history[historyPosition], &polyphaseTaps[phase * numberOfTapsPerPhase], numberOfTapsPerPhase);
+
+		outputSignals[0]->bufferPut(value);
+		space--;
+		alive = true;
+
+		phase++;
+		if (phase == numberOfSamplesPerSymbol) phase = 0;
+	}
+
+	return alive;
+};
+
+bool PolyphasePulseShaper::shapeFixedPoint(void) {
+
+	Signal *in = inputSignals[0];
+	Signal *out = outputSignals[0];
+
+	const DspKernels &kernels = dspKernels();
+
+	// The products of the symbol and tap codes are exact, with the fraction bits of both.
+	int accumulatorFractionBits = in->getFractionBits() + tapsFixedPointFormat.fractionBits;
+	int history = numberOfTapsPerPhase - 1;
+
+	bool alive{ false };
+
+	// The shaped samples are written first, then the symbols of the contiguous part of the input buffer are shaped, a span at a time.
+	while (true) {
+		while (fixedOutputsPending > 0) {
+			int n = min(fixedOutputsPending, out->contiguousSpace());
+			if (n <= 0) break;
+
+			const t_fixed *samples = fixedOutputs.data() + fixedOutputs.size() - fixedOutputsPending;
+			copy(samples, samples + n, static_cast<t_fixed *>(out->buffer) + out->inPosition);
+			out->commitPut(n);
+			fixedOutputsPending = fixedOutputsPending - n;
+			alive = true;
+		}
+		if (fixedOutputsPending > 0) break;
+
+		int symbols = min(in->contiguousReady(), FIXED_POINT_SPAN);
+		if (symbols <= 0) break;
+
+		const t_fixed *codes = static_cast<t_fixed *>(in->buffer) + in->outPosition;
+		copy(codes, codes + symbols, fixedSymbolHistory.begin() + history);
+		in->commitGet(symbols);
+		alive = true;
+
+		// The window of symbol s starts at fixedSymbolHistory[s], the oldest symbol first.
+		int samples = symbols * numberOfSamplesPerSymbol;
+		t_fixed *shaped = fixedOutputs.data() + fixedOutputs.size() - samples;
+		if (fixedFirKernel != nullptr) {
+			fixedFirKernel(fixedSymbolHistory.data(), fixedTapPairs.data(), fixedAccumulators.data(), symbols);
+			outputFixedPointFormat.requantize(fixedAccumulators.data(), accumulatorFractionBits, shaped, samples);
+		}
+		else {
+			for (int k = 0; k < symbols; k++) {
+				for (int p = 0; p < numberOfSamplesPerSymbol; p++) {
+					long long accumulator = kernels.fixedDotProduct(&fixedSymbolHistory[k], &fixedPolyphaseTaps[p * numberOfTapsPerPhase], numberOfTapsPerPhase);
+					shaped[k * numberOfSamplesPerSymbol + p] = outputFixedPointFormat.requantize(accumulator, accumulatorFractionBits);
+				}
+			}
+		}
+		fixedOutputsPending = samples;
+
+		copy(fixedSymbolHistory.begin() + symbols, fixedSymbolHistory.begin() + symbols + history, fixedSymbolHistory.begin());
+	}
+
+	return alive;
+};
@@ -1,27 +1,85 @@
+# include <map>
+# include <set>
+# include <tuple>
+# include <mutex>
+# include <fstream>
+
 # include "netplus.h"
 # include "pulse_shaper.h"
 
 using namespace std;
 
-void raisedCosine(vector<t_real> &impulseResponse, int impulseResponseLength, double rollOffFactor, double samplingPeriod, double symbolPeriod);
-
 void PulseShaper::initialize(void) {
 
 	double samplingPeriod = inputSignals[0]->samplingPeriod;
 	double symbolPeriod = inputSignals[0]->symbolPeriod;
 
+	taps = getPulseShaperTaps(getFilterType(), rollOffFactor, impulseResponseTimeLength, samplingPeriod, symbolPeriod);
+
+	impulseResponseLength = taps->size();
+	impulseResponse.assign(taps->data(), taps->data() + impulseResponseLength);
+
+	initializeFIR_Filter();
+}
+
+PulseShaperTaps::PulseShaperTaps(PulseShaperFilter filterType, double rollOffFactor, int impulseResponseTimeLength, double samplingPeriod, double symbolPeriod) {
+
 	impulseResponseLength = (int)floor(impulseResponseTimeLength * symbolPeriod / samplingPeriod);
 
-	impulseResponse.resize(impulseResponseLength);
+	vector<t_real> impulseResponse(impulseResponseLength);
 
-	switch (getFilterType()) {
+	switch (filterType) {
 
 		case RaisedCosine:
 			raisedCosine(impulseResponse, impulseResponseLength, rollOffFactor, samplingPeriod, symbolPeriod);
 			break;
 	};
 
-	initializeFIR_Filter();
+	// vector only guarantees the alignment of t_real, the taps start at the first aligned element.
+	int alignment = TAPS_ALIGNMENT / sizeof(t_real);
+	storage.assign(impulseResponseLength + alignment, 0.0);
+	offset = (int)((TAPS_ALIGNMENT - ((size_t)storage.data()) % TAPS_ALIGNMENT) % TAPS_ALIGNMENT) / sizeof(t_real);
+	copy(impulseResponse.begin(), impulseResponse.end(), storage.begin() + offset);
+}
+
+void PulseShaper::writeImpulseResponse(void) {
+	taps->save("./signals/" + getImpulseResponseFilename(), inputSignals[0]->samplingPeriod);
+}
+
+void PulseShaperTaps::save(string fileName, double samplingPeriod) const {
+
+	// The I and Q shapers, and the later runs of the process, share the taps: each (taps, file, sampling period) is written once.
+	static mutex savedMutex;
+	static set<tuple<const PulseShaperTaps *, string, double>> saved;
+	{
+		lock_guard<mutex> lock(savedMutex);
+		if (!saved.insert(make_tuple(this, fileName, samplingPeriod)).second) return;
+	}
+
+	ofstream fileHandler(fileName, ios::out);
+	fileHandler << "// ### HEADER TERMINATOR ###\n";
+
+	t_real t;
+	for (int i = 0; i < impulseResponseLength; i++) {
+		t = -impulseResponseLength / 2 * samplingPeriod + i * samplingPeriod;
+		fileHandler << t << " " << (*this)[i] << "\n";
+	}
+	fileHandler.close();
+}
+
+shared_ptr<const PulseShaperTaps> getPulseShaperTaps(PulseShaperFilter filterType, double rollOffFactor, int impulseResponseTimeLength, double samplingPeriod, double symbolPeriod) {
+
+	static mutex cacheMutex;
+	static map<tuple<int, double, double, int>, shared_ptr<const PulseShaperTaps>> cache;
+
+	tuple<int, double, double, int> key{ filterType, rollOffFactor, symbolPeriod / samplingPeriod, impulseResponseTimeLength };
+
+	lock_guard<mutex> lock(cacheMutex);
+
+	shared_ptr<const PulseShaperTaps> &taps = cache[key];
+	if (!taps) taps = make_shared<const PulseShaperTaps>(filterType, rollOffFactor, impulseResponseTimeLength, samplingPeriod, symbolPeriod);
+
+	return taps;
 }
 
 void raisedCosine(vector<t_real> &impulseResponse, int impulseResponseLength, double rollOffFactor, double samplingPeriod, double symbolPeriod) {
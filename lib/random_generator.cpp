@@ -0,0 +1,92 @@
+# include <atomic>
+# include <cmath>
+# include <limits>
+
+# include "netplus.h"
+# include "random_generator.h"
+# include "dsp_kernels.h"
+
+using namespace std;
+
+const int RNG_CHUNK = 256;		// samples converted at a time, from a buffer on the stack
+
+static atomic<uint64_t> runSeed{ 0 };
+
+void setRunSeed(uint64_t seed) { runSeed = seed; }
+
+uint64_t getRunSeed(void) { return runSeed; }
+
+static atomic<uint64_t> nextDefaultStream{ 1ULL << 32 };
+
+uint64_t newDefaultStream(void) { return nextDefaultStream++; }
+
+void CounterRng::words(uint64_t first, uint64_t *out, int n) const {
+
+	if (n <= 0) return;
+
+	// Sample i is word i % 2 of block i / 2, the blocks that are only half used are computed apart.
+	uint64_t block[2];
+	if (first % 2) {
+		dspKernels().philox(seed, stream, first / 2, block, 1);
+		out[0] = block[1];
+		first++;
+		out++;
+		n--;
+	}
+	if (n / 2 > 0) dspKernels().philox(seed, stream, first / 2, out, n / 2);
+	if (n % 2) {
+		dspKernels().philox(seed, stream, (first + n - 1) / 2, block, 1);
+		out[n - 1] = block[0];
+	}
+}
+
+void CounterRng::uniform(uint64_t first, t_real *out, int n) const {
+
+	// The top digits bits of each word, so that the value is exact and below 1.
+	const int digits = numeric_limits<t_real>::digits;
+	const t_real scale = ldexp((t_real) 1.0, -digits);
+
+	uint64_t values[RNG_CHUNK];
+	for (int k = 0; k < n; k += RNG_CHUNK) {
+		int m = min(RNG_CHUNK, n - k);
+		words(first + k, values, m);
+		for (int i = 0; i < m; i++) out[k + i] = (t_real)(values[i] >> (64 - digits)) * scale;
+	}
+}
+
+void CounterRng::gaussian(uint64_t first, t_real *out, int n) const {
+
+	// Samples 2p and 2p + 1 are the two outputs of Box-Muller for the two words of block p.
+	uint64_t values[RNG_CHUNK];
+	t_real pairs[RNG_CHUNK];
+	uint64_t pair = first / 2;
+	int k = -(int)(first % 2);
+	while (k < n) {
+		int numberOfPairs = min(RNG_CHUNK / 2, (n - k + 1) / 2);
+		dspKernels().philox(seed, stream, pair, values, numberOfPairs);
+		dspKernels().boxMuller(values, pairs, numberOfPairs);
+		int begin = max(-k, 0);
+		int end = min(2 * numberOfPairs, n - k);
+		copy(pairs + begin, pairs + end, out + k + begin);
+		k = k + 2 * numberOfPairs;
+		pair = pair + numberOfPairs;
+	}
+}
+
+void CounterRng::bernoulli(uint64_t first, double probabilityOfZero, t_binary *out, int n) const {
+
+	// P(0) = threshold / 2^64, a probabilityOfZero of 1 cannot be expressed as a threshold.
+	if (probabilityOfZero >= 1.0) {
+		fill(out, out + max(n, 0), 0);
+		return;
+	}
+	uint64_t threshold{ 0 };
+	if (probabilityOfZero > 0.0) threshold = (uint64_t) ldexp(probabilityOfZero, 64);
+
+	uint64_t values[RNG_CHUNK];
+	for (int k = 0; k < n; k += RNG_CHUNK) {
+		int m = min(RNG_CHUNK, n - k);
+		words(first + k, values, m);
+		dspKernels().thresholdBits(values, threshold, out + k, m);
+	}
+}
@@ -48,10 +48,18 @@ bool Sink::runBlock(void)
 		for (int i = 0; i<process; i++) static_cast<TimeContinuousAmplitudeContinuousComplex *>(inputSignals[0])->bufferGet();*/
 
 
-	for (int i = 0; i<process; i++) (inputSignals[0])->bufferGet();
+	// The samples are discarded in one step, and the remaining number of samples is displayed at most once per displayInterval,
+	// and when the last one is consumed.
+	(inputSignals[0])->skip(process);
 
 	numberOfSamples = numberOfSamples - process;
-	if (displayNumberOfSamples) cout << numberOfSamples << "\n";
+	if (displayNumberOfSamples) {
+		chrono::steady_clock::time_point now = chrono::steady_clock::now();
+		if ((numberOfSamples == 0) || (chrono::duration<double>(now - lastDisplay).count() >= displayInterval)) {
+			lastDisplay = now;
+			cout << numberOfSamples << "\n";
+		}
+	}
 
 	return true;
 }
@@ -0,0 +1,100 @@
+# include <algorithm>	// std::max
+# include <cstdlib>		// getenv, atoi, free
+
+# include "worker_pool.h"
+
+using namespace std;
+
+static thread_local bool insideTask = false;
+
+WorkerPool::WorkerPool(int numberOfWorkers) {
+
+	for (int k = 0; k < numberOfWorkers; k++) workers.emplace_back(&WorkerPool::workerLoop, this);
+}
+
+WorkerPool::~WorkerPool() {
+
+	{
+		lock_guard<mutex> lock(poolMutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (thread &worker : workers) worker.join();
+}
+
+void WorkerPool::run(int count, const function<void(int)> &t) {
+
+	if ((count <= 1) || workers.empty() || insideTask) {
+		for (int i = 0; i < count; i++) t(i);
+		return;
+	}
+
+	lock_guard<mutex> serial(runMutex);
+
+	{
+		lock_guard<mutex> lock(poolMutex);
+		task = &t;
+		taskCount = count;
+		nextIndex = 0;
+		busyWorkers = (int) workers.size();
+		generation++;
+	}
+	wake.notify_all();
+
+	work();
+
+	// Every worker goes through the task, possibly finding no index left, before the next one can start.
+	unique_lock<mutex> lock(poolMutex);
+	done.wait(lock, [this] { return busyWorkers == 0; });
+	task = nullptr;
+}
+
+void WorkerPool::work(void) {
+
+	insideTask = true;
+	for (int i = nextIndex++; i < taskCount; i = nextIndex++) (*task)(i);
+	insideTask = false;
+}
+
+void WorkerPool::workerLoop(void) {
+
+	uint64_t seen = 0;
+	while (true) {
+		{
+			unique_lock<mutex> lock(poolMutex);
+			wake.wait(lock, [&] { return stopping || (generation != seen); });
+			if (stopping) return;
+			seen = generation;
+		}
+
+		work();
+
+		lock_guard<mutex> lock(poolMutex);
+		if (--busyWorkers == 0) done.notify_one();
+	}
+}
+
+static int numberOfPoolThreads(void) {
+
+	int threads = max(1, (int) thread::hardware_concurrency());
+
+# if defined(_MSC_VER)
+	char *value{ nullptr };
+	size_t length{ 0 };
+	if ((_dupenv_s(&value, &length, "NETPLUS_THREADS") == 0) && (value != nullptr)) {
+		if (atoi(value) > 0) threads = atoi(value);
+		free(value);
+	}
+# else
+	const char *value = getenv("NETPLUS_THREADS");
+	if ((value != nullptr) && (atoi(value) > 0)) threads = atoi(value);
+# endif
+
+	return threads;
+}
+
+WorkerPool &workerPool(void) {
+
+	static WorkerPool pool(numberOfPoolThreads() - 1);
+	return pool;
+}
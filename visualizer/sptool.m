@@ -4109,12 +4109,19 @@ symbolPeriod = str2double(char(symbolPeriod(end)));
 samplingPeriod = strsplit(fgetl(fid), {' ', ':'});
 samplingPeriod = str2double(char(samplingPeriod(end)));
 
-%% Terminator and flagT
+%% Terminator, precision and flagT (files without a precision line were written in double)
 str = '';
 terminator = '// ### HEADER TERMINATOR ###';
+setGlobalt_real('double');
+setGlobalt_complex('double');
 counterT = 0; flagT = 1;
 while ~strcmp(str, terminator)
     str = fgetl(fid);
+    if strncmp(str, 'Precision:', 10)
+        precision = strsplit(str, {' ', ':'});
+        setGlobalt_real(char(precision(end)));
+        setGlobalt_complex(char(precision(end)));
+    end
     counterT = counterT + 1;
     if counterT > 100
         flagT = 0;